@@ -1,73 +1,33 @@
-#include <glad/gl.h>
-#include <glfw/glfw3.h>
-#include <stdio.h>
-#include <stdlib.h>
+#include "shared/CommandLine.h"
+#include "shared/glFramework/GLApp.h"
+#include "shared/glFramework/GLBenchmark.h"
+#include <memory>
 
-GLFWwindow *createWindow(int majorVersion, int minorVersion, int profile, int width, int height,
-	const char *title, GLFWmonitor *monitor = nullptr, GLFWwindow *share = nullptr) {
+int main(int argc, char **argv) {
+	CommandLine commandLine(argc, argv);
 
-	glfwSetErrorCallback(
-		[](int error, const char *description) {
-			fprintf(stderr, "Error: %s\n", description);
-		}
-	);
-
-	if (!glfwInit()) {
-		return nullptr;
-	}
-
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, majorVersion);
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, minorVersion);
-	glfwWindowHint(GLFW_OPENGL_PROFILE, profile);
-	GLFWwindow *window = glfwCreateWindow(width, height, title, monitor, share);
-	if (!window) {
-		glfwTerminate();
-		return nullptr;
+	// We request an OpenGL 4.6 context in a 1080p window
+	GLApp app(4, 6, GLFW_OPENGL_CORE_PROFILE, 1920, 1080, "Main window");
+
+	// --benchmark renders a fixed number of frames with a fixed time step and writes their CPU and GPU times as JSON.
+	// See GLBenchmark for its options
+	std::unique_ptr<GLBenchmark> benchmark;
+	GLBenchmark::Settings benchmarkSettings;
+	if (GLBenchmark::parseSettings(commandLine, benchmarkSettings)) {
+		benchmark = std::make_unique<GLBenchmark>(app, "Example01", benchmarkSettings);
 	}
 
-	return window;
-}
-
-void addHandlers(GLFWwindow *window) {
-	glfwSetKeyCallback(window,
-		[](GLFWwindow *window, int key, int scancode, int action, int mods) {
-			if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS) {
-				glfwSetWindowShouldClose(window, GLFW_TRUE);
+	// Nothing to draw yet, the app just swaps buffers and polls events until the window is closed.
+	// A benchmark of it measures the cost of the frame loop itself
+	app.run([&](float ratio) {
+		if (benchmark) {
+			benchmark->beginFrame();
+			benchmark->endFrame();
+			if (benchmark->isFinished()) {
+				app.close();
 			}
 		}
-	);
-}
-
-void configureGL(GLFWwindow *window) {
-	glfwMakeContextCurrent(window);
-	gladLoadGL(glfwGetProcAddress);
-	glfwSwapInterval(1);
-}
-
-void renderLoop(GLFWwindow *window) {
-	while (!glfwWindowShouldClose(window)) {
-		glfwSwapBuffers(window);
-		glfwPollEvents();
-	}
-}
-
-void destroyWindow(GLFWwindow *window) {
-	glfwDestroyWindow(window);
-	glfwTerminate();
-}
-
-int main() {
-	
-	// We request an OpenGL 4.6 context in a 1080p window
-	GLFWwindow* window = createWindow(4, 6, GLFW_OPENGL_CORE_PROFILE, 1920, 1080, "Main window");
-	if (!window) {
-		exit(EXIT_FAILURE);
-	}
-
-	addHandlers(window);
-	configureGL(window);
-	renderLoop(window);
-	destroyWindow(window);
+	});
 
 	return 0;
-}
\ No newline at end of file
+}
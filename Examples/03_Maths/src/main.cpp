@@ -1,79 +1,19 @@
-#include <glad/gl.h>
-#include <glfw/glfw3.h>
+#include "shared/CommandLine.h"
+#include "shared/glFramework/GLApp.h"
+#include "shared/glFramework/GLBenchmark.h"
+#include "shared/glFramework/GLShader.h"
+#include "shared/glFramework/GLVertexArray.h"
 #include <glm/glm.hpp>
 #include <glm/ext.hpp>
-#include <stdio.h>
-#include <stdlib.h>
+#include <memory>
 
 using glm::mat4;
 using glm::vec3;
 
-static const char *vertexShaderCode = R"(
-#version 460 core
-// We define a layout with the same data as the one in the buffer
-// See https://www.khronos.org/opengl/wiki/Interface_Block_(GLSL)#Memory_layout
-// for more information
-layout (std140, location=0) uniform PerFrameData {
-	uniform mat4 MVP;
-	uniform int isWireframe;
-};
-layout (location=0) out vec3 color;
-const vec3 pos[8] = vec3[8] (
-	vec3(-1.0, -1.0, 1.0), vec3(1.0, -1.0, 1.0),
-	vec3(1.0, 1.0, 1.0), vec3(-1.0, 1.0, 1.0),
-	vec3(-1.0, -1.0, -1.0), vec3(1.0, -1.0, -1.0),
-	vec3(1.0, 1.0, -1.0), vec3(-1.0, 1.0, -1.0)
-);
-const vec3 col[8] = vec3[8] (
-	vec3(1.0, 0.0, 0.0), vec3(0.0, 1.0, 0.0),
-	vec3(0.0, 0.0, 1.0), vec3(1.0, 1.0, 0.0),
-	vec3(1.0, 1.0, 0.0), vec3(0.0, 0.0, 1.0),
-	vec3(0.0, 1.0, 0.0), vec3(1.0, 0.0, 0.0)
-);
-const int indices[36] = int[36] (
-	// front
-	0, 1, 2, 2, 3, 0,
-	// right
-	1, 5, 6, 6, 2, 1,
-	// back
-	7, 6, 5, 5, 4, 7,
-	// left
-	4, 0, 3, 3, 7, 4,
-	// bottom
-	4, 5, 1, 1, 0, 4,
-	// top
-	3, 2, 6, 6, 7, 3
-);
-void main() {
-	int index = indices[gl_VertexID];
-	gl_Position = MVP * vec4(pos[index], 1.0);
-	color = isWireframe > 0 ? vec3(0.0) : col[index];
-}
-)";
-static const char* fragmentShaderCode = R"(
-#version 460 core
-layout (location=0) in vec3 color;
-layout (location=0) out vec4 out_FragColor;
-void main() {
-	out_FragColor = vec4(color, 1.0);
-}
-)";
-
-GLFWwindow* createWindow(int, int, int, int, int,
-	const char*, GLFWmonitor *monitor = nullptr, GLFWwindow *share = nullptr);
-void addHandlers(GLFWwindow*);
-GLuint createVAO();
-GLuint createProgram(GLuint, GLuint);
-GLuint createShader(const GLchar* const*, unsigned int);
 GLuint createBuffer();
-void configureGL(GLFWwindow*);
-void renderLoop(GLFWwindow*, GLuint);
-float resizeWindow(GLFWwindow*);
-void clear(GLFWwindow*);
+void clear();
 void setup();
-void draw(GLFWwindow*, GLuint, GLsizeiptr, const float);
-void destroyWindow(GLFWwindow*);
-void destroyResources(GLuint, GLuint, GLuint, GLuint, GLuint);
+void draw(const GLApp&, GLuint, GLsizeiptr, const float);
 
 // Define a uniform buffer to pass data to the shader
 struct PerFrameData
@@ -82,100 +22,48 @@ struct PerFrameData
 	int isWireframe;
 };
 
-int main() {
+int main(int argc, char **argv) {
+	CommandLine commandLine(argc, argv);
 
 	// We request an OpenGL 4.6 context in a 1080p window
-	GLFWwindow* window = createWindow(4, 6, GLFW_OPENGL_CORE_PROFILE, 1920, 1080, "Main window");
-	if (!window) {
-		exit(EXIT_FAILURE);
-	}
-
-	addHandlers(window);
-	configureGL(window);
-	GLuint vaoId = createVAO();
-	GLuint vsId = createShader(&vertexShaderCode, GL_VERTEX_SHADER);
-	GLuint fsId = createShader(&fragmentShaderCode, GL_FRAGMENT_SHADER);
-	GLuint programId = createProgram(vsId, fsId);
+	GLApp app(4, 6, GLFW_OPENGL_CORE_PROFILE, 1920, 1080, "Main window");
+
+	GLVertexArray vao;
+	vao.bind();
+	GLShader vs("data/shaders/03_Maths.vert");
+	GLShader fs("data/shaders/03_Maths.frag");
+	GLProgram program(vs, fs);
+	program.useProgram();
 	GLuint perFrameDataBuffer = createBuffer();
-	renderLoop(window, perFrameDataBuffer);
-	destroyResources(vaoId, vsId, fsId, programId, perFrameDataBuffer);
-	destroyWindow(window);
 
-	return 0;
-}
-
-GLFWwindow *createWindow(int majorVersion, int minorVersion, int profile, int width, int height,
-	const char *title, GLFWmonitor *monitor, GLFWwindow *share) {
-
-	glfwSetErrorCallback(
-		[](int error, const char *description) {
-			fprintf(stderr, "Error: %s\n", description);
-		}
-	);
-
-	if (!glfwInit()) {
-		return nullptr;
-	}
-
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, majorVersion);
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, minorVersion);
-	glfwWindowHint(GLFW_OPENGL_PROFILE, profile);
-	GLFWwindow *window = glfwCreateWindow(width, height, title, monitor, share);
-	if (!window) {
-		glfwTerminate();
-		return nullptr;
+	// --benchmark renders a fixed number of frames with a fixed time step and writes their CPU and GPU times as JSON.
+	// See GLBenchmark for its options
+	std::unique_ptr<GLBenchmark> benchmark;
+	GLBenchmark::Settings benchmarkSettings;
+	if (GLBenchmark::parseSettings(commandLine, benchmarkSettings)) {
+		benchmark = std::make_unique<GLBenchmark>(app, "Example03", benchmarkSettings);
 	}
 
-	return window;
-}
-
-void addHandlers(GLFWwindow *window) {
-	glfwSetKeyCallback(window,
-		[](GLFWwindow *window, int key, int scancode, int action, int mods) {
-			if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS) {
-				glfwSetWindowShouldClose(window, GLFW_TRUE);
+	app.run([&](float ratio) {
+		if (benchmark) {
+			benchmark->beginFrame();
+		}
+		clear();
+		setup();
+		draw(app, perFrameDataBuffer, sizeof(PerFrameData), ratio);
+		if (benchmark) {
+			// The cube and its wireframe
+			benchmark->addDrawCalls(2, 2);
+			benchmark->endFrame();
+			if (benchmark->isFinished()) {
+				app.close();
 			}
 		}
-	);
-}
-
-GLuint createVAO() {
-	GLuint vao;
-	glCreateVertexArrays(1, &vao);
-	glBindVertexArray(vao);
-	return vao;
-}
+	});
 
-GLuint createProgram(GLuint vsId, GLuint fsId) {
-	const GLuint program = glCreateProgram();
-	glAttachShader(program, vsId);
-	glAttachShader(program, fsId);
-	glLinkProgram(program);
-	glUseProgram(program);
-	return program;
-}
-
-GLuint createShader(const GLchar *const *source, unsigned int shaderType) {
-	const GLuint shader = glCreateShader(shaderType);
-	glShaderSource(shader, 1, source, nullptr);
-	glCompileShader(shader);
-	GLint isCompiled = 0;
-	glGetShaderiv(shader, GL_COMPILE_STATUS, &isCompiled);
-	if (isCompiled == GL_FALSE)
-	{
-		GLint maxLength = 0;
-		glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &maxLength);
-
-		// The maxLength includes the NULL character
-		GLchar *errorLog = new GLchar[(int)maxLength];
-		glGetShaderInfoLog(shader, maxLength, &maxLength, errorLog);
+	glDeleteBuffers(1, &perFrameDataBuffer);
 
-		fprintf(stderr, "Error compiling shader: %s\n", errorLog);
-		glDeleteShader(shader); // Don't leak the shader.
-		delete[] errorLog;
-		return -1;
-	}
-	return shader;
+	return 0;
 }
 
 GLuint createBuffer() {
@@ -190,34 +78,7 @@ GLuint createBuffer() {
 	return perFrameDataBuffer;
 }
 
-void configureGL(GLFWwindow *window) {
-	glfwMakeContextCurrent(window);
-	gladLoadGL(glfwGetProcAddress);
-	glfwSwapInterval(1);
-}
-
-void renderLoop(GLFWwindow *window, GLuint perFrameDataBuffer) {
-	const GLsizeiptr kBufferSize = sizeof(PerFrameData);
-
-	while (!glfwWindowShouldClose(window)) {
-		const float ratio = resizeWindow(window);
-		clear(window);
-		setup();
-		draw(window, perFrameDataBuffer, kBufferSize, ratio);
-
-		glfwSwapBuffers(window);
-		glfwPollEvents();
-	}
-}
-
-float resizeWindow(GLFWwindow *window) {
-	int width, height;
-	glfwGetFramebufferSize(window, &width, &height);
-	glViewport(0, 0, width, height);
-	return width / (float)height;
-}
-
-void clear(GLFWwindow *window) {
+void clear() {
 	glClearColor(.0f, .0f, .0f, .0f);
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 }
@@ -229,9 +90,9 @@ void setup() {
 	glPolygonOffset(-1.0f, -1.0f);
 }
 
-void draw(GLFWwindow* window, GLuint perFrameDataBuffer, GLsizeiptr kBufferSize, const float ratio) {
-	// We rotate the cube on the (1, 1, 1) axis by glfwGetTime() and then we translate it backwards to see it
-	const mat4 m = glm::rotate(glm::translate(mat4(1.0f), vec3(0.0f, 0.0f, -3.5f)), (float)glfwGetTime(), vec3(1.0f, 1.0f, 1.0f));
+void draw(const GLApp &app, GLuint perFrameDataBuffer, GLsizeiptr kBufferSize, const float ratio) {
+	// We rotate the cube on the (1, 1, 1) axis by the elapsed time and then we translate it backwards to see it
+	const mat4 m = glm::rotate(glm::translate(mat4(1.0f), vec3(0.0f, 0.0f, -3.5f)), (float)app.getTime(), vec3(1.0f, 1.0f, 1.0f));
 	const mat4 p = glm::perspective(45.0f, ratio, 0.1f, 1000.0f);
 
 	// Draw the cube
@@ -246,16 +107,3 @@ void draw(GLFWwindow* window, GLuint perFrameDataBuffer, GLsizeiptr kBufferSize,
 	glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
 	glDrawArrays(GL_TRIANGLES, 0, 36);
 }
-
-void destroyResources(GLuint vaoID, GLuint vsId, GLuint fsId, GLuint progId, GLuint perFrameDataBuffer) {
-	glDeleteBuffers(1, &perFrameDataBuffer);
-	glDeleteProgram(progId);
-	glDeleteShader(vsId);
-	glDeleteShader(fsId);
-	glDeleteVertexArrays(1, &vaoID);
-}
-
-void destroyWindow(GLFWwindow *window) {
-	glfwDestroyWindow(window);
-	glfwTerminate();
-}
\ No newline at end of file
@@ -1,181 +1,175 @@
-#include <glad/gl.h>
-#include <glfw/glfw3.h>
+#include "shared/CommandLine.h"
+#include "shared/EasyProfilerWrapper.h"
+#include "shared/ProfilerCapture.h"
+#include "shared/glFramework/GLApp.h"
+#include "shared/glFramework/GLBenchmark.h"
+#include "shared/glFramework/GLFrameCapture.h"
+#include "shared/glFramework/GLGpuTimers.h"
+#include "shared/glFramework/GLReadbackQueue.h"
+#include "shared/glFramework/GLRingBuffer.h"
+#include "shared/glFramework/GLProgramCache.h"
+#include "shared/glFramework/GLProgramReloader.h"
+#include "shared/glFramework/GLShader.h"
+#include "shared/glFramework/GLStateCache.h"
+#include "shared/glFramework/GLTextureLoader.h"
+#include "shared/glFramework/GLVertexArray.h"
 #include <glm/glm.hpp>
 #include <glm/ext.hpp>
 #include <filesystem>
+#include <memory>
 
-#define STB_IMAGE_IMPLEMENTATION
-#include "stb_image.h"
-#define STB_IMAGE_WRITE_IMPLEMENTATION
 #include "stb/stb_image_write.h"
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <algorithm>
 #include <chrono>
 #include <ctime>
 
 using glm::mat4;
 using glm::vec3;
 
-static const char* vertexShaderCode = R"(
-#version 460 core
-// We define a layout with the same data as the one in the buffer
-// See https://www.khronos.org/opengl/wiki/Interface_Block_(GLSL)#Memory_layout
-// for more information
-layout (std140, location=0) uniform PerFrameData {
-	uniform mat4 MVP;
-	uniform int isWireframe;
-	// We need to use padding because buffer offsets are 16 bit aligned
-	uniform int padding1;
-	uniform int padding2;
-	uniform int padding3;
-};
-layout (location=0) out vec2 uv;
-const vec3 pos[8] = vec3[8] (
-	vec3(-1.0, -1.0, 1.0), vec3(1.0, -1.0, 1.0),
-	vec3(1.0, 1.0, 1.0), vec3(-1.0, 1.0, 1.0),
-	vec3(-1.0, -1.0, -1.0), vec3(1.0, -1.0, -1.0),
-	vec3(1.0, 1.0, -1.0), vec3(-1.0, 1.0, -1.0)
-);
-const vec2 tc[6] = vec2[6](
-	vec2( 0.0, 0.0 ),
-	vec2( 1.0, 0.0 ),
-	vec2( 1.0, 1.0 ),
-	vec2( 1.0, 1.0 ),
-	vec2( 0.0, 1.0 ),
-	vec2( 0.0, 0.0 )
-);
-const int indices[36] = int[36] (
-	// front
-	0, 1, 2, 2, 3, 0,
-	// right
-	1, 5, 6, 6, 2, 1,
-	// back
-	7, 6, 5, 5, 4, 7,
-	// left
-	4, 0, 3, 3, 7, 4,
-	// bottom
-	4, 5, 1, 1, 0, 4,
-	// top
-	3, 2, 6, 6, 7, 3
-);
-void main() {
-	int index = indices[gl_VertexID];
-	gl_Position = MVP * vec4(pos[index], 1.0);
-	uv = tc[gl_VertexID % 6];
-}
-)";
-static const char* fragmentShaderCode = R"(
-#version 460 core
-layout (location=0) in vec2 uv;
-layout (location=0) out vec4 out_FragColor;
-uniform sampler2D texture0;
-void main() {
-	out_FragColor = texture(texture0, uv);
-}
-)";
-
-GLFWwindow* createWindow(int, int, int, int, int,
-	const char*, GLFWmonitor *monitor = nullptr, GLFWwindow *share = nullptr);
-void addHandlers(GLFWwindow*);
-void captureScreenshot(GLFWwindow*);
+void captureScreenshot(const GLApp&, GLReadbackQueue&);
 std::string getCurrentTimeString();
 std::string timeToString(const std::tm*);
 std::tm* getCurrentTime();
-GLuint createVAO();
-GLuint createProgram(GLuint, GLuint);
-GLuint createShader(const GLchar* const*, unsigned int);
-GLuint createBuffer();
-void configureGL(GLFWwindow*);
-void loadTexture();
-void renderLoop(GLFWwindow*, GLuint);
-float resizeWindow(GLFWwindow*);
-void clear(GLFWwindow*);
-void setup();
-GLuint loadImage(GLuint, const char*, GLuint, GLuint);
-void draw(GLFWwindow*, GLuint, GLsizeiptr, const float);
-void destroyWindow(GLFWwindow*);
-void destroyResources(GLuint, GLuint, GLuint, GLuint, GLuint);
+void clear();
+void setup(GLStateCache&);
+void draw(const GLApp&, GLRingBuffer&, GLGpuTimers&, GLStateCache&, bool, const float);
+void printGpuTimings(const GLGpuTimers&);
 
 // Define a uniform buffer to pass data to the shader
 struct PerFrameData
 {
 	mat4 mvp;
 	int isWireframe;
-	int padding1;
+	int singlePassWireframe;
 	int padding2;
 	int padding3;
 };
 
-int main() {
-
-	// We request an OpenGL 4.6 context in a 1080p window
-	GLFWwindow* window = createWindow(4, 6, GLFW_OPENGL_CORE_PROFILE, 1920, 1080, "Main window");
-	if (!window) {
-		exit(EXIT_FAILURE);
+int main(int argc, char **argv) {
+	CommandLine commandLine(argc, argv);
+	// --profile-frames N records the startup and the first N frames with Easy Profiler, then exits
+	ProfilerCapture profilerCapture(commandLine);
+
+	// We request an OpenGL 4.6 context in a 1080p window. --headless renders offscreen instead, for machines
+	// without a display, and --frames N stops after N frames
+	const GLApp::Backend backend = commandLine.hasOption("headless") ? GLApp::Backend::Headless : GLApp::Backend::Window;
+	GLApp app(4, 6, GLFW_OPENGL_CORE_PROFILE, 1920, 1080, "Main window", backend);
+	app.setMaxFrames((uint32_t)std::max<int64_t>(0, commandLine.getInt("frames", 0)));
+	// --time-step [S] advances the time S seconds every frame instead of following the clock, 1/60 without S.
+	// Frames are then the same on every run, SoftRaster renders the same ones on the CPU
+	if (commandLine.hasOption("time-step")) {
+		app.setFixedTimeStep(commandLine.getDouble("time-step", 1.0 / 60.0));
 	}
-
-	addHandlers(window);
-	configureGL(window);
-	GLuint vaoId = createVAO();
-	GLuint vsId = createShader(&vertexShaderCode, GL_VERTEX_SHADER);
-	GLuint fsId = createShader(&fragmentShaderCode, GL_FRAGMENT_SHADER);
-	GLuint programId = createProgram(vsId, fsId);
-	GLuint perFrameDataBuffer = createBuffer();
-	loadTexture();
-	renderLoop(window, perFrameDataBuffer);
-	destroyResources(vaoId, vsId, fsId, programId, perFrameDataBuffer);
-	destroyWindow(window);
-
-	return 0;
-}
-
-GLFWwindow *createWindow(int majorVersion, int minorVersion, int profile, int width, int height,
-	const char *title, GLFWmonitor *monitor, GLFWwindow *share) {
-
-	glfwSetErrorCallback(
-		[](int error, const char *description) {
-			fprintf(stderr, "Error: %s\n", description);
-		}
-	);
-
-	if (!glfwInit()) {
-		return nullptr;
+	// The screenshot is taken at the end of the next frame, before swapping, so the back buffer has valid contents
+	bool screenshotRequested = false;
+	app.addKeyHandler(GLFW_KEY_F9, [&]() { screenshotRequested = true; });
+	// W switches between drawing the wireframe in a second pass with GL_LINE and in the same pass as the cube.
+	// --single-pass-wireframe starts with the latter
+	bool singlePassWireframe = commandLine.hasOption("single-pass-wireframe");
+	app.addKeyHandler(GLFW_KEY_W, [&]() { singlePassWireframe = !singlePassWireframe; });
+
+	GLVertexArray vao;
+	vao.bind();
+	// The state set every frame goes through the cache, which only calls GL when it changes
+	GLStateCache stateCache;
+	// Linked programs are cached, so only the first run compiles the shaders
+	GLProgramCache programCache;
+	GLProgram program(programCache, "data/shaders/05_STB.vert", "data/shaders/05_STB.frag");
+	// We need two PerFrameData blocks each frame, one for the cube and one for the wireframe
+	GLRingBuffer perFrameDataBuffer(sizeof(PerFrameData), 2);
+	// The image is decoded and its mipmaps generated in the background, the loader binds a placeholder until it's uploaded
+	GLTextureLoader textureLoader;
+	const GLTextureLoader::Handle texture = textureLoader.load("data/ch2_sample3_STB.jpg", GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR, MipFilter::Kaiser);
+	GLReadbackQueue readbackQueue;
+	// The solid and wireframe passes are timed on the GPU, --gpu-timings prints their averages every second
+	GLGpuTimers gpuTimers;
+	const bool printTimings = commandLine.hasOption("gpu-timings");
+	double lastPrintTime = 0.0;
+	// The driver links the program while the rest is set up, this is where we wait for it
+	program.useProgram();
+	// Shaders saved while the example runs are rebuilt and swapped in between frames
+	GLProgramReloader programReloader;
+	programReloader.add(program);
+
+	// Frame sequences are recorded when --capture is passed in the command line. See GLFrameCapture for its options
+	std::unique_ptr<GLFrameCapture> frameCapture;
+	GLFrameCapture::Settings captureSettings;
+	if (GLFrameCapture::parseSettings(commandLine, captureSettings)) {
+		frameCapture = std::make_unique<GLFrameCapture>(captureSettings);
 	}
 
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, majorVersion);
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, minorVersion);
-	glfwWindowHint(GLFW_OPENGL_PROFILE, profile);
-	GLFWwindow *window = glfwCreateWindow(width, height, title, monitor, share);
-	if (!window) {
-		glfwTerminate();
-		return nullptr;
+	// --benchmark renders a fixed number of frames with a fixed time step and writes their CPU and GPU times as JSON.
+	// See GLBenchmark for its options
+	std::unique_ptr<GLBenchmark> benchmark;
+	GLBenchmark::Settings benchmarkSettings;
+	if (GLBenchmark::parseSettings(commandLine, benchmarkSettings)) {
+		// Named after the wireframe mode, so running both writes two reports to compare
+		benchmark = std::make_unique<GLBenchmark>(app, singlePassWireframe ? "Example05_SinglePass" : "Example05_TwoPass", benchmarkSettings);
+		benchmark->trackStateCache(stateCache);
 	}
 
-	return window;
-}
+	app.run([&](float ratio) {
+		if (benchmark) {
+			benchmark->beginFrame();
+		}
+		programReloader.update();
+		clear();
+		setup(stateCache);
+		textureLoader.update();
+		stateCache.bindTextureUnit(0, textureLoader.getTexture(texture));
+		gpuTimers.beginFrame();
+		perFrameDataBuffer.beginFrame();
+		draw(app, perFrameDataBuffer, gpuTimers, stateCache, singlePassWireframe, ratio);
+		if (benchmark) {
+			benchmark->addDrawCalls(singlePassWireframe ? 1 : 2, singlePassWireframe ? 1 : 2);
+		}
+		perFrameDataBuffer.endFrame();
+		gpuTimers.endFrame();
+		if (printTimings && app.getTime() - lastPrintTime >= 1.0) {
+			printGpuTimings(gpuTimers);
+			lastPrintTime = app.getTime();
+		}
 
-void addHandlers(GLFWwindow *window) {
-	glfwSetKeyCallback(window,
-		[](GLFWwindow *window, int key, int scancode, int action, int mods) {
-			if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS) {
-				glfwSetWindowShouldClose(window, GLFW_TRUE);
+		if (screenshotRequested) {
+			captureScreenshot(app, readbackQueue);
+			screenshotRequested = false;
+		}
+		readbackQueue.update();
+
+		if (frameCapture) {
+			int width, height;
+			app.getFramebufferSize(width, height);
+			frameCapture->endFrame(width, height);
+			if (frameCapture->isFinished()) {
+				app.close();
 			}
-			else if (key == GLFW_KEY_F9 && action == GLFW_PRESS) {
-				captureScreenshot(window);
+		}
+		if (benchmark) {
+			benchmark->endFrame();
+			if (benchmark->isFinished()) {
+				app.close();
 			}
 		}
-	);
+		profilerCapture.endFrame();
+		if (profilerCapture.isFinished()) {
+			app.close();
+		}
+	});
+
+	return 0;
 }
 
-void captureScreenshot(GLFWwindow *window) {
+void captureScreenshot(const GLApp &app, GLReadbackQueue &readbackQueue) {
 	int width, height;
-	std::string now = getCurrentTimeString();
-	glfwGetFramebufferSize(window, &width, &height);
-	uint8_t* ptr = (uint8_t*)malloc(width * height * 4);
-	glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, ptr);
-	stbi_write_png((now + ".png").c_str(), width, height, 4, ptr, 0);
-	free(ptr);
+	std::string fileName = getCurrentTimeString() + ".png";
+	app.getFramebufferSize(width, height);
+	// The pixels reach the worker thread a few frames later and the PNG is encoded there
+	readbackQueue.requestReadback(width, height, [fileName](const uint8_t *pixels, int width, int height) {
+		stbi_write_png(fileName.c_str(), width, height, 4, pixels, 0);
+	});
 }
 
 std::string getCurrentTimeString() {
@@ -195,146 +189,66 @@ std::tm* getCurrentTime() {
 	return std::localtime(&now);
 }
 
-void configureGL(GLFWwindow* window) {
-	glfwMakeContextCurrent(window);
-	gladLoadGL(glfwGetProcAddress);
-	glfwSwapInterval(1);
-}
-
-GLuint createVAO() {
-	GLuint vao;
-	glCreateVertexArrays(1, &vao);
-	glBindVertexArray(vao);
-	return vao;
-}
-
-GLuint createProgram(GLuint vsId, GLuint fsId) {
-	const GLuint program = glCreateProgram();
-	glAttachShader(program, vsId);
-	glAttachShader(program, fsId);
-	glLinkProgram(program);
-	glUseProgram(program);
-	return program;
-}
-
-GLuint createShader(const GLchar *const *source, unsigned int shaderType) {
-	const GLuint shader = glCreateShader(shaderType);
-	glShaderSource(shader, 1, source, nullptr);
-	glCompileShader(shader);
-	GLint isCompiled = 0;
-	glGetShaderiv(shader, GL_COMPILE_STATUS, &isCompiled);
-	if (isCompiled == GL_FALSE)
-	{
-		GLint maxLength = 0;
-		glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &maxLength);
-
-		// The maxLength includes the NULL character
-		GLchar *errorLog = new GLchar[(int)maxLength];
-		glGetShaderInfoLog(shader, maxLength, &maxLength, errorLog);
-
-		fprintf(stderr, "Error compiling shader: %s\n", errorLog);
-		glDeleteShader(shader); // Don't leak the shader.
-		delete[] errorLog;
-		return -1;
-	}
-	return shader;
-}
-
-GLuint createBuffer() {
-	const GLsizeiptr kBufferSize = sizeof(PerFrameData);
-
-	// We use the Direct-State-Access (DSA) functions instead of the classic bind-to-edit approach
-	GLuint perFrameDataBuffer;
-	glCreateBuffers(1, &perFrameDataBuffer);
-	// We use GL_DYNAMIC_STORAGE_BIT to tell OpenGL we might update the content of the data store
-	// We'll set a double-sized buffer to account for each rendering state
-	glNamedBufferStorage(perFrameDataBuffer, kBufferSize * 2, nullptr, GL_DYNAMIC_STORAGE_BIT);
-	return perFrameDataBuffer;
-}
-
-void renderLoop(GLFWwindow *window, GLuint perFrameDataBuffer) {
-	const GLsizeiptr kBufferSize = sizeof(PerFrameData);
-
-	while (!glfwWindowShouldClose(window)) {
-		const float ratio = resizeWindow(window);
-		clear(window);
-		setup();
-		draw(window, perFrameDataBuffer, kBufferSize, ratio);
-
-		glfwSwapBuffers(window);
-		glfwPollEvents();
-	}
-}
-
-float resizeWindow(GLFWwindow *window) {
-	int width, height;
-	glfwGetFramebufferSize(window, &width, &height);
-	glViewport(0, 0, width, height);
-	return width / (float)height;
-}
-
-void clear(GLFWwindow *window) {
+void clear() {
+	EASY_FUNCTION();
 	glClearColor(.0f, .0f, .0f, .0f);
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 }
 
-void setup() {
-	glEnable(GL_DEPTH_TEST);
-	glEnable(GL_POLYGON_OFFSET_LINE);
+void setup(GLStateCache &stateCache) {
+	EASY_FUNCTION();
+	stateCache.enable(GL_DEPTH_TEST);
+	stateCache.enable(GL_POLYGON_OFFSET_LINE);
 	// We use the polygon offset to render a wireframe on top of the solid image without z-fighting
-	glPolygonOffset(-1.0f, -1.0f);
-
-}
+	stateCache.polygonOffset(-1.0f, -1.0f);
 
-void loadTexture() {
-	GLuint texture = loadImage(0, "data/ch2_sample3_STB.jpg", GL_LINEAR, GL_LINEAR);
-	glBindTextures(0, 1, &texture);
 }
 
-GLuint loadImage(GLuint bindLocation, const char *path, GLuint minFilter, GLuint maxFilter) {
-	int w, h, comp;
-	const uint8_t* img = stbi_load(path, &w, &h, &comp, 3);
-	GLuint texture;
-	glCreateTextures(GL_TEXTURE_2D, 1, &texture);
-	glTextureParameteri(texture, GL_TEXTURE_MAX_LEVEL, 0);
-	glTextureParameteri(texture, GL_TEXTURE_MIN_FILTER, minFilter);
-	glTextureParameteri(texture, GL_TEXTURE_MAG_FILTER, maxFilter);
-	glTextureStorage2D(texture, 1, GL_RGB8, w, h);
-	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-	glTextureSubImage2D(texture, 0, 0, 0, w, h, GL_RGB, GL_UNSIGNED_BYTE, img);
-	stbi_image_free((void*)img);
-	return texture;
-}
-
-void draw(GLFWwindow* window, GLuint perFrameDataBuffer, GLsizeiptr kBufferSize, const float ratio) {
-	// We rotate the cube on the (1, 1, 1) axis by glfwGetTime() and then we translate it backwards to see it
-	const mat4 m = glm::rotate(glm::translate(mat4(1.0f), vec3(0.0f, 0.0f, -3.5f)), (float)glfwGetTime(), vec3(1.0f, 1.0f, 1.0f));
+void draw(const GLApp &app, GLRingBuffer &perFrameDataBuffer, GLGpuTimers &gpuTimers, GLStateCache &stateCache,
+	bool singlePassWireframe, const float ratio) {
+	EASY_FUNCTION();
+	// We rotate the cube on the (1, 1, 1) axis by the elapsed time and then we translate it backwards to see it
+	const mat4 m = glm::rotate(glm::translate(mat4(1.0f), vec3(0.0f, 0.0f, -3.5f)), (float)app.getTime(), vec3(1.0f, 1.0f, 1.0f));
 	const mat4 p = glm::perspective(45.0f, ratio, 0.1f, 1000.0f);
 
+	// The fragment shader draws the edges from the barycentric coordinates of each fragment, a single draw is enough
+	if (singlePassWireframe) {
+		GLGpuTimerScope scope(gpuTimers, "SolidWireframe");
+		const PerFrameData data = { .mvp = p * m, .isWireframe = false, .singlePassWireframe = true };
+		perFrameDataBuffer.bindRange(0, perFrameDataBuffer.upload(&data, sizeof(PerFrameData)), stateCache);
+		stateCache.polygonMode(GL_FILL);
+		glDrawArrays(GL_TRIANGLES, 0, 36);
+		return;
+	}
+
 	// Define the two instances of perFrameData that we'll use to render the cube and the wireframe
-	PerFrameData perFrameData[2] = { {.mvp = p * m, .isWireframe = false }, {.mvp = p * m, .isWireframe = true } };
-	glNamedBufferSubData(perFrameDataBuffer, 0, kBufferSize * 2, perFrameData);
+	// and write them directly into the persistently mapped ring buffer
+	const PerFrameData cubeData = { .mvp = p * m, .isWireframe = false };
+	const PerFrameData wireframeData = { .mvp = p * m, .isWireframe = true };
+	const GLRingBuffer::Allocation cube = perFrameDataBuffer.upload(&cubeData, sizeof(PerFrameData));
+	const GLRingBuffer::Allocation wireframe = perFrameDataBuffer.upload(&wireframeData, sizeof(PerFrameData));
 
 	// Draw the cube
-	glBindBufferRange(GL_UNIFORM_BUFFER, 0, perFrameDataBuffer, 0, kBufferSize);
-	glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-	glDrawArrays(GL_TRIANGLES, 0, 36);
+	{
+		GLGpuTimerScope scope(gpuTimers, "Solid");
+		perFrameDataBuffer.bindRange(0, cube, stateCache);
+		stateCache.polygonMode(GL_FILL);
+		glDrawArrays(GL_TRIANGLES, 0, 36);
+	}
 
 	// Draw the wireframe
-	glBindBufferRange(GL_UNIFORM_BUFFER, 0, perFrameDataBuffer, kBufferSize, kBufferSize);
-	glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-	glDrawArrays(GL_TRIANGLES, 0, 36);
+	{
+		GLGpuTimerScope scope(gpuTimers, "Wireframe");
+		perFrameDataBuffer.bindRange(0, wireframe, stateCache);
+		stateCache.polygonMode(GL_LINE);
+		glDrawArrays(GL_TRIANGLES, 0, 36);
+	}
 }
 
-void destroyResources(GLuint vaoID, GLuint vsId, GLuint fsId, GLuint progId, GLuint perFrameDataBuffer) {
-	glDeleteBuffers(1, &perFrameDataBuffer);
-	glDeleteProgram(progId);
-	glDeleteShader(vsId);
-	glDeleteShader(fsId);
-	glDeleteVertexArrays(1, &vaoID);
+void printGpuTimings(const GLGpuTimers &gpuTimers) {
+	printf("GPU:");
+	for (const GLGpuTimers::Timing &timing : gpuTimers.getTimings()) {
+		printf(" %s %.3f ms", timing.name, timing.averageMs);
+	}
+	printf(" (%u frames dropped)\n", gpuTimers.getNumDroppedFrames());
 }
-
-void destroyWindow(GLFWwindow *window) {
-	glfwDestroyWindow(window);
-	glfwTerminate();
-}
\ No newline at end of file
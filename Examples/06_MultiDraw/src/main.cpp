@@ -0,0 +1,226 @@
+#include "shared/CommandLine.h"
+#include "shared/EasyProfilerWrapper.h"
+#include "shared/ProfilerCapture.h"
+#include "shared/glFramework/GLApp.h"
+#include "shared/glFramework/GLBatchRenderer.h"
+#include "shared/glFramework/GLBenchmark.h"
+#include "shared/glFramework/GLProgramCache.h"
+#include "shared/glFramework/GLProgramReloader.h"
+#include "shared/glFramework/GLRingBuffer.h"
+#include "shared/glFramework/GLShader.h"
+#include "shared/glFramework/GLStateCache.h"
+#include "shared/scene/MeshData.h"
+#include "shared/scene/MeshImport.h"
+#include "shared/scene/MeshLOD.h"
+#include "shared/scene/TransformBatch.h"
+#include <glm/glm.hpp>
+#include <glm/ext.hpp>
+
+#include <math.h>
+#include <stdio.h>
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+using glm::mat4;
+using glm::vec3;
+
+void clear();
+void setup(GLStateCache&);
+void addCube(GLBatchRenderer&);
+
+// Define a uniform buffer to pass data to the shader
+struct PerFrameData
+{
+	mat4 viewProj;
+};
+
+// The transforms of every object and the matrices computeTransforms writes from them every frame
+struct Objects
+{
+	TransformBatch transforms;
+	std::vector<mat4> models;
+	std::vector<mat4> modelViews;
+};
+
+void layoutObjects(Objects&, uint32_t, float);
+void draw(const GLApp&, GLBatchRenderer&, GLRingBuffer&, GLStateCache&, Objects&, uint32_t, float, bool, float);
+
+// Draws a grid of thousands of rotating objects with one glMultiDrawElementsIndirect per frame.
+// By default the objects are cubes, --mesh <scene> draws an imported scene instead, with its LOD
+// selected per object and per frame. --count N sets the number of objects (10000 by default).
+int main(int argc, char **argv) {
+	CommandLine commandLine(argc, argv);
+	// --profile-frames N records the startup and the first N frames with Easy Profiler, then exits
+	ProfilerCapture profilerCapture(commandLine);
+	const uint32_t numObjects = (uint32_t)std::max<int64_t>(1, commandLine.getInt("count", 10000));
+
+	// We request an OpenGL 4.6 context in a 1080p window. --headless renders offscreen instead, for machines
+	// without a display, and --frames N stops after N frames
+	const GLApp::Backend backend = commandLine.hasOption("headless") ? GLApp::Backend::Headless : GLApp::Backend::Window;
+	GLApp app(4, 6, GLFW_OPENGL_CORE_PROFILE, 1920, 1080, "Main window", backend);
+	app.setMaxFrames((uint32_t)std::max<int64_t>(0, commandLine.getInt("frames", 0)));
+
+	// Linked programs are cached, so only the first run compiles the shaders
+	GLProgramCache programCache;
+	GLProgram program(programCache, "data/shaders/06_MultiDraw.vert", "data/shaders/06_MultiDraw.frag");
+	GLRingBuffer perFrameDataBuffer(sizeof(PerFrameData), 1);
+	// The state set every frame goes through the cache, which only calls GL when it changes
+	GLStateCache stateCache;
+
+	// Every object draws all the meshes of the scene, a cube is a single mesh
+	MeshData meshData;
+	std::unique_ptr<GLBatchRenderer> renderer;
+	uint32_t numMeshes = 1;
+	// The distance between objects in the grid, a cube is 2 units wide
+	float spacing = 4.0f;
+	if (commandLine.hasOption("mesh")) {
+		const std::string path = commandLine.getString("mesh", "");
+		if (!loadMeshCached(path, meshData)) {
+			return 1;
+		}
+		numMeshes = meshData.getNumMeshes();
+		renderer = std::make_unique<GLBatchRenderer>(meshData.getVertexFormat(), numObjects * numMeshes);
+		renderer->addMeshes(meshData);
+		float radius = 0.0f;
+		for (uint32_t i = 0; i < numMeshes; ++i) {
+			const float *sphere = meshData.getMesh(i).boundingSphere;
+			radius = std::max(radius, glm::length(vec3(sphere[0], sphere[1], sphere[2])) + sphere[3]);
+		}
+		spacing = radius * 2.0f;
+	}
+	else {
+		renderer = std::make_unique<GLBatchRenderer>(VertexFormat::Float32, numObjects);
+		addCube(*renderer);
+	}
+	Objects objects;
+	layoutObjects(objects, numObjects, spacing);
+	// The driver links the program while the scene loads, this is where we wait for it
+	program.useProgram();
+	// Shaders saved while the example runs are rebuilt and swapped in between frames
+	GLProgramReloader programReloader;
+	programReloader.add(program);
+
+	// --benchmark renders a fixed number of frames with a fixed time step and writes their CPU and GPU times as JSON.
+	// See GLBenchmark for its options
+	std::unique_ptr<GLBenchmark> benchmark;
+	GLBenchmark::Settings benchmarkSettings;
+	if (GLBenchmark::parseSettings(commandLine, benchmarkSettings)) {
+		benchmark = std::make_unique<GLBenchmark>(app, "Example06", benchmarkSettings);
+		benchmark->trackStateCache(stateCache);
+	}
+
+	app.run([&](float ratio) {
+		if (benchmark) {
+			benchmark->beginFrame();
+		}
+		programReloader.update();
+		clear();
+		setup(stateCache);
+		perFrameDataBuffer.beginFrame();
+		renderer->beginFrame();
+		draw(app, *renderer, perFrameDataBuffer, stateCache, objects, numMeshes, spacing, commandLine.hasOption("mesh"), ratio);
+		renderer->endFrame(&stateCache);
+		if (benchmark) {
+			// Every draw of the frame goes through a single glMultiDrawElementsIndirect
+			benchmark->addDrawCalls(renderer->getNumDraws() > 0 ? 1 : 0, renderer->getNumDraws());
+		}
+		perFrameDataBuffer.endFrame();
+		if (benchmark) {
+			benchmark->endFrame();
+			if (benchmark->isFinished()) {
+				app.close();
+			}
+		}
+		profilerCapture.endFrame();
+		if (profilerCapture.isFinished()) {
+			app.close();
+		}
+	});
+
+	return 0;
+}
+
+void clear() {
+	EASY_FUNCTION();
+	glClearColor(.0f, .0f, .0f, .0f);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+}
+
+void setup(GLStateCache &stateCache) {
+	EASY_FUNCTION();
+	stateCache.enable(GL_DEPTH_TEST);
+	stateCache.enable(GL_CULL_FACE);
+}
+
+void addCube(GLBatchRenderer &renderer) {
+	// 4 vertices per face so every face gets its own normal. Position, normal and uv as in VertexFormat::Float32
+	const vec3 normals[6] = {
+		vec3(0.0f, 0.0f, 1.0f), vec3(1.0f, 0.0f, 0.0f), vec3(0.0f, 0.0f, -1.0f),
+		vec3(-1.0f, 0.0f, 0.0f), vec3(0.0f, -1.0f, 0.0f), vec3(0.0f, 1.0f, 0.0f)
+	};
+	std::vector<float> vertices;
+	std::vector<uint32_t> indices;
+	for (uint32_t face = 0; face < 6; ++face) {
+		const vec3 n = normals[face];
+		// Two axes perpendicular to the normal that make the face counter-clockwise seen from outside
+		const vec3 u = fabsf(n.y) > 0.5f ? vec3(1.0f, 0.0f, 0.0f) : glm::cross(vec3(0.0f, 1.0f, 0.0f), n);
+		const vec3 v = glm::cross(n, u);
+		const float corners[4][2] = { { -1.0f, -1.0f }, { 1.0f, -1.0f }, { 1.0f, 1.0f }, { -1.0f, 1.0f } };
+		const uint32_t first = face * 4;
+		for (const auto &corner : corners) {
+			const vec3 p = n + u * corner[0] + v * corner[1];
+			vertices.insert(vertices.end(), { p.x, p.y, p.z, n.x, n.y, n.z, corner[0] * 0.5f + 0.5f, corner[1] * 0.5f + 0.5f });
+		}
+		indices.insert(indices.end(), { first, first + 1, first + 2, first + 2, first + 3, first });
+	}
+	renderer.addMesh(vertices.data(), (uint32_t)vertices.size() / kMeshVertexComponents, indices.data(), (uint32_t)indices.size());
+}
+
+// The objects are laid out in a square grid on the XZ plane, centered on the origin
+void layoutObjects(Objects &objects, uint32_t numObjects, float spacing) {
+	const uint32_t gridSize = (uint32_t)ceilf(sqrtf((float)numObjects));
+	objects.transforms.resize(numObjects);
+	for (uint32_t i = 0; i < numObjects; ++i) {
+		objects.transforms.setPosition(i, vec3((i % gridSize - gridSize * 0.5f) * spacing, 0.0f, (i / gridSize - gridSize * 0.5f) * spacing));
+	}
+	objects.models.resize(numObjects);
+	objects.modelViews.resize(numObjects);
+}
+
+void draw(const GLApp &app, GLBatchRenderer &renderer, GLRingBuffer &perFrameDataBuffer, GLStateCache &stateCache,
+	Objects &objects, uint32_t numMeshes, float spacing, bool useLODs, float ratio) {
+	EASY_FUNCTION();
+	// We look at the grid from above one of its sides
+	const uint32_t numObjects = (uint32_t)objects.transforms.size();
+	const uint32_t gridSize = (uint32_t)ceilf(sqrtf((float)numObjects));
+	const float extent = gridSize * spacing;
+	const mat4 v = glm::lookAt(vec3(0.0f, extent * 0.35f, extent * 0.75f), vec3(0.0f), vec3(0.0f, 1.0f, 0.0f));
+	const mat4 p = glm::perspective(45.0f, ratio, 0.1f, std::max(1000.0f, extent * 2.0f));
+
+	const PerFrameData perFrameData = { .viewProj = p * v };
+	perFrameDataBuffer.bindRange(0, perFrameDataBuffer.upload(&perFrameData, sizeof(PerFrameData)), stateCache);
+
+	int width, height;
+	app.getFramebufferSize(width, height);
+	const float time = (float)app.getTime();
+	// Every object spins around the same axis with its own phase
+	const vec3 axis = glm::normalize(vec3(1.0f, 1.0f, 1.0f));
+	for (uint32_t i = 0; i < numObjects; ++i) {
+		objects.transforms.setRotation(i, glm::angleAxis(time + i * 0.1f, axis));
+	}
+	// The model matrices of every object in one SIMD pass, with their model-view matrices when the LODs need them
+	if (useLODs) {
+		computeTransforms(objects.transforms, v, objects.modelViews.data(), objects.models.data());
+	}
+	else {
+		computeTransforms(objects.transforms, mat4(1.0f), objects.models.data());
+	}
+	for (uint32_t i = 0; i < numObjects; ++i) {
+		for (GLBatchRenderer::MeshHandle mesh = 0; mesh < numMeshes; ++mesh) {
+			const uint32_t lod = useLODs ? selectLOD(renderer.getMesh(mesh), objects.modelViews[i], p, (float)height) : 0;
+			renderer.draw(mesh, objects.models[i], lod);
+		}
+	}
+}
@@ -0,0 +1,102 @@
+#include "shared/CommandLine.h"
+#include "shared/scene/MeshData.h"
+#include "shared/scene/MeshImport.h"
+#include "shared/scene/MeshOptimize.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+// Imports a scene with Assimp, optimizes it with meshoptimizer and writes it in our binary mesh format,
+// then loads it back to compare the load time of both paths.
+//
+// Usage: MeshConvert --input <scene.obj|scene.gltf> [--output <file.mesh>]
+//        [--no-optimize] [--quantize] [--report]
+// Without --output the mesh is written where loadMeshCached looks for it.
+// --report prints the ACMR, ATVR and overdraw of every mesh before and after the optimizations.
+
+using Clock = std::chrono::steady_clock;
+
+double getMilliseconds(Clock::time_point start) {
+	return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+int main(int argc, char **argv) {
+	CommandLine commandLine(argc, argv);
+	if (!commandLine.hasOption("input")) {
+		fprintf(stderr, "Usage: MeshConvert --input <scene.obj|scene.gltf> [--output <file.mesh>] [--no-optimize] [--quantize] [--report]\n");
+		return EXIT_FAILURE;
+	}
+
+	const std::string input = commandLine.getString("input", "");
+	const std::string output = commandLine.getString("output", getMeshCachePath(input, ".cache/meshes"));
+	MeshOptimizeSettings settings;
+	if (commandLine.hasOption("no-optimize")) {
+		settings.optimizeVertexCache = false;
+		settings.optimizeOverdraw = false;
+		settings.optimizeVertexFetch = false;
+	}
+	settings.quantize = commandLine.hasOption("quantize");
+	// The same key loadMeshCached uses so it picks our file up
+	const uint64_t sourceKey = hashMeshOptimizeSettings(settings, getMeshSourceKey(input));
+
+	Clock::time_point start = Clock::now();
+	MeshDataBuffers buffers;
+	if (!importMesh(input, buffers)) {
+		return EXIT_FAILURE;
+	}
+	const double importTime = getMilliseconds(start);
+
+	start = Clock::now();
+	std::vector<MeshOptimizeStats> stats;
+	const bool report = commandLine.hasOption("report");
+	optimizeMeshData(buffers, settings, report ? &stats : nullptr);
+	const double optimizeTime = getMilliseconds(start);
+
+	if (!saveMeshData(output, buffers, sourceKey)) {
+		return EXIT_FAILURE;
+	}
+
+	// Loading maps the file, so we also touch every page to measure reading it from disk
+	start = Clock::now();
+	MeshData meshData;
+	if (!meshData.load(output, sourceKey)) {
+		fprintf(stderr, "Error loading %s back\n", output.c_str());
+		return EXIT_FAILURE;
+	}
+	uint64_t checksum = 0;
+	for (size_t i = 0; i < meshData.getVertexDataSize(); i += 4096) {
+		checksum += meshData.getVertexData()[i];
+	}
+	for (size_t i = 0; i < meshData.getIndexDataSize(); i += 4096) {
+		checksum += meshData.getIndexData()[i];
+	}
+	const double loadTime = getMilliseconds(start);
+
+	printf("%s -> %s\n", input.c_str(), output.c_str());
+	printf("%u meshes, %zu vertices, %zu triangles, %u bit indices\n", meshData.getNumMeshes(),
+		buffers.vertexData.size() / kMeshVertexComponents, buffers.indexData.size() / 3, meshData.getIndexSize() * 8);
+	printf("Assimp import: %.1f ms, optimization: %.1f ms, binary load: %.1f ms (checksum %llu)\n",
+		importTime, optimizeTime, loadTime, (unsigned long long)checksum);
+
+	// Triangles of every LOD level over all meshes. Meshes too small to simplify count their coarsest LOD
+	for (uint32_t lod = 0; lod < kMaxLODs; ++lod) {
+		size_t triangles = 0;
+		float maxError = 0.0f;
+		for (uint32_t i = 0; i < meshData.getNumMeshes(); ++i) {
+			const Mesh &mesh = meshData.getMesh(i);
+			const uint32_t meshLOD = std::min(lod, mesh.lodCount - 1);
+			triangles += mesh.getLODIndexCount(meshLOD) / 3;
+			maxError = std::max(maxError, mesh.lodError[meshLOD]);
+		}
+		printf("LOD %u: %zu triangles, max error %g\n", lod, triangles, maxError);
+	}
+
+	if (report) {
+		printMeshOptimizeReport(stats);
+	}
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,173 @@
+#include "shared/CommandLine.h"
+#include "shared/scene/MeshData.h"
+#include "shared/scene/MeshImport.h"
+#include "shared/scene/Meshlets.h"
+
+#include <glm/glm.hpp>
+#include <glm/ext.hpp>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <string>
+#include <vector>
+
+// Builds the meshlets of a scene and culls them on the CPU from a ring of cameras, without a GPU.
+// For every view the culled triangle list is validated against a brute-force reference that tests every
+// triangle on its own, and the culling pass is timed.
+//
+// Usage: MeshletCull --input <scene.obj|scene.gltf> [--views N] [--iterations N]
+// Returns EXIT_FAILURE when the culled list misses a visible triangle or contains one that isn't in the scene.
+
+using glm::mat4;
+using glm::vec3;
+using glm::vec4;
+using Clock = std::chrono::steady_clock;
+using Triangle = std::array<uint32_t, 3>;
+
+double getMilliseconds(Clock::time_point start) {
+	return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// Rotated so the smallest index goes first, which keeps the winding
+Triangle makeTriangle(uint32_t a, uint32_t b, uint32_t c) {
+	if (b < a && b < c) {
+		return { b, c, a };
+	}
+	if (c < a && c < b) {
+		return { c, a, b };
+	}
+	return { a, b, c };
+}
+
+std::vector<Triangle> getTriangles(const std::vector<uint32_t> &indices) {
+	std::vector<Triangle> triangles;
+	for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+		triangles.push_back(makeTriangle(indices[i], indices[i + 1], indices[i + 2]));
+	}
+	std::sort(triangles.begin(), triangles.end());
+	return triangles;
+}
+
+vec3 getPosition(const std::vector<float> &positions, uint32_t vertex) {
+	return vec3(positions[vertex * 3], positions[vertex * 3 + 1], positions[vertex * 3 + 2]);
+}
+
+// The triangles that are clearly front facing and not clearly outside the frustum. Triangles closer than
+// epsilon to either test are left out so float rounding can't fail the validation
+std::vector<Triangle> getVisibleTriangles(const std::vector<Triangle> &triangles, const std::vector<float> &positions,
+	const mat4 &viewProj, const vec3 &cameraPosition, float sceneRadius) {
+	const float kFacingEpsilon = 1e-3f;
+	const float distanceEpsilon = 1e-4f * sceneRadius;
+	vec4 planes[6];
+	getFrustumPlanes(viewProj, planes);
+
+	std::vector<Triangle> visible;
+	for (const Triangle &triangle : triangles) {
+		const vec3 a = getPosition(positions, triangle[0]);
+		const vec3 b = getPosition(positions, triangle[1]);
+		const vec3 c = getPosition(positions, triangle[2]);
+		const vec3 normal = glm::cross(b - a, c - a);
+		const float normalLength = glm::length(normal);
+		const vec3 toTriangle = a - cameraPosition;
+		const float toTriangleLength = glm::length(toTriangle);
+		if (normalLength == 0.0f || toTriangleLength == 0.0f ||
+			glm::dot(normal, toTriangle) > -kFacingEpsilon * normalLength * toTriangleLength) {
+			continue;
+		}
+
+		bool outside = false;
+		for (int i = 0; i < 6 && !outside; ++i) {
+			const vec3 n = vec3(planes[i]);
+			outside =
+				glm::dot(n, a) + planes[i].w < distanceEpsilon &&
+				glm::dot(n, b) + planes[i].w < distanceEpsilon &&
+				glm::dot(n, c) + planes[i].w < distanceEpsilon;
+		}
+		if (!outside) {
+			visible.push_back(triangle);
+		}
+	}
+	return visible;
+}
+
+int main(int argc, char **argv) {
+	CommandLine commandLine(argc, argv);
+	if (!commandLine.hasOption("input")) {
+		fprintf(stderr, "Usage: MeshletCull --input <scene.obj|scene.gltf> [--views N] [--iterations N]\n");
+		return EXIT_FAILURE;
+	}
+	const std::string input = commandLine.getString("input", "");
+	const int numViews = (int)std::max<int64_t>(1, commandLine.getInt("views", 16));
+	const int iterations = (int)std::max<int64_t>(1, commandLine.getInt("iterations", 100));
+
+	MeshData meshData;
+	if (!loadMeshCached(input, meshData)) {
+		return EXIT_FAILURE;
+	}
+
+	Clock::time_point start = Clock::now();
+	MeshletData meshletData;
+	buildMeshlets(meshData, meshletData);
+	printf("%zu meshlets built in %.1f ms\n", meshletData.meshlets.size(), getMilliseconds(start));
+
+	// Every triangle of LOD 0 with absolute vertex indices, the reference works on these instead of the meshlets
+	std::vector<float> positions;
+	getVertexPositions(meshData, positions);
+	std::vector<uint32_t> sceneIndices;
+	vec3 minBounds(1e30f);
+	vec3 maxBounds(-1e30f);
+	for (uint32_t m = 0; m < meshData.getNumMeshes(); ++m) {
+		const Mesh &mesh = meshData.getMesh(m);
+		for (uint32_t i = 0; i < mesh.indexCount; ++i) {
+			const uint32_t vertex = mesh.vertexOffset + meshData.getIndex(mesh.indexOffset + i);
+			sceneIndices.push_back(vertex);
+			minBounds = glm::min(minBounds, getPosition(positions, vertex));
+			maxBounds = glm::max(maxBounds, getPosition(positions, vertex));
+		}
+	}
+	const std::vector<Triangle> sceneTriangles = getTriangles(sceneIndices);
+	const vec3 sceneCenter = (minBounds + maxBounds) * 0.5f;
+	const float sceneRadius = std::max(glm::length(maxBounds - minBounds) * 0.5f, 1e-3f);
+
+	printf("%6s %10s %10s %10s %12s %12s %10s\n", "View", "Cone", "Frustum", "Triangles", "Reference", "Time (ms)", "Result");
+	int failures = 0;
+	std::vector<uint32_t> culledIndices;
+	for (int view = 0; view < numViews; ++view) {
+		// Even views orbit the scene looking at its center, odd ones stand inside it looking along the orbit
+		// so a large part of the scene is behind them or to their sides
+		const float angle = 6.2831853f * view / numViews;
+		const vec3 direction(cosf(angle), 0.3f, sinf(angle));
+		const bool inside = view % 2 == 1;
+		const vec3 eye = sceneCenter + direction * sceneRadius * (inside ? 0.3f : 1.5f);
+		const vec3 target = inside ? eye + vec3(-sinf(angle), 0.0f, cosf(angle)) : sceneCenter;
+		const mat4 viewProj = glm::perspective(45.0f, 16.0f / 9.0f, sceneRadius * 0.001f, sceneRadius * 10.0f) *
+			glm::lookAt(eye, target, vec3(0.0f, 1.0f, 0.0f));
+
+		MeshletCullingStats stats;
+		start = Clock::now();
+		for (int i = 0; i < iterations; ++i) {
+			cullMeshlets(meshletData, viewProj, eye, culledIndices, &stats);
+		}
+		const double time = getMilliseconds(start) / iterations;
+
+		// The culled list must only contain triangles of the scene, as many times as the scene has them at most,
+		// and it must contain every triangle the reference sees
+		const std::vector<Triangle> culled = getTriangles(culledIndices);
+		const std::vector<Triangle> reference = getVisibleTriangles(sceneTriangles, positions, viewProj, eye, sceneRadius);
+		const bool valid =
+			std::includes(sceneTriangles.begin(), sceneTriangles.end(), culled.begin(), culled.end()) &&
+			std::includes(culled.begin(), culled.end(), reference.begin(), reference.end());
+		if (!valid) {
+			++failures;
+		}
+
+		printf("%6d %10u %10u %10u %12zu %12.3f %10s\n", view, stats.culledByCone, stats.culledByFrustum,
+			stats.visibleTriangles, reference.size(), time, valid ? "OK" : "FAILED");
+	}
+
+	printf("%zu triangles in the scene, %d of %d views failed validation\n", sceneTriangles.size(), failures, numViews);
+	return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
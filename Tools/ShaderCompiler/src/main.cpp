@@ -0,0 +1,114 @@
+#include "shared/CommandLine.h"
+#include "shared/ShaderCompiler.h"
+#include "taskflow/taskflow.hpp"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Compiles every GLSL shader under a folder to SPIR-V, writing <file>.spv next to each one.
+// The build runs it on data/shaders and fails when a shader doesn't compile, so the examples never
+// meet an invalid shader at runtime. Shaders whose SPIR-V is newer than their source are skipped.
+//
+// Usage: ShaderCompiler [--directory <folder>] [--force] [--jobs N]
+
+struct CompileResult {
+	bool compiled = false;
+	bool skipped = false;
+	std::string log;
+};
+
+bool writeSPIRV(const std::string&, const std::vector<uint32_t>&);
+
+int main(int argc, char **argv) {
+	CommandLine commandLine(argc, argv);
+	const std::string directory = commandLine.getString("directory", "data/shaders");
+	const bool force = commandLine.hasOption("force");
+	// The executor needs at least one worker, a zero or negative --jobs would also wrap around as unsigned
+	const unsigned int jobs = (unsigned int)std::max<int64_t>(1,
+		commandLine.getInt("jobs", std::max(1u, std::thread::hardware_concurrency())));
+
+	std::vector<std::string> shaders;
+	std::error_code error;
+	for (const auto &entry : std::filesystem::recursive_directory_iterator(directory, error)) {
+		if (entry.is_regular_file() && isShaderFile(entry.path().string().c_str())) {
+			shaders.push_back(entry.path().string());
+		}
+	}
+	if (error) {
+		fprintf(stderr, "Can't read the shader folder %s: %s\n", directory.c_str(), error.message().c_str());
+		return EXIT_FAILURE;
+	}
+	// Sorted so the report reads the same on every run
+	std::sort(shaders.begin(), shaders.end());
+
+	// Every shader is compiled on its own, glslang keeps no state between them
+	const auto start = std::chrono::steady_clock::now();
+	std::vector<CompileResult> results(shaders.size());
+	tf::Executor executor(jobs);
+	tf::Taskflow taskflow;
+	taskflow.for_each_index(0, (int)shaders.size(), 1, [&](int i) {
+		const char *fileName = shaders[i].c_str();
+		CompileResult &result = results[i];
+		if (!force && isShaderSPIRVUpToDate(fileName)) {
+			result.compiled = result.skipped = true;
+			return;
+		}
+		std::vector<uint32_t> spirv;
+		result.compiled = compileShaderToSPIRV(fileName, spirv, result.log);
+		if (result.compiled && !writeSPIRV(getShaderSPIRVPath(fileName), spirv)) {
+			result.compiled = false;
+			result.log += "Can't write " + getShaderSPIRVPath(fileName) + "\n";
+		}
+	});
+	executor.run(taskflow).wait();
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	int compiled = 0, skipped = 0, failed = 0;
+	for (size_t i = 0; i < shaders.size(); ++i) {
+		const CompileResult &result = results[i];
+		// Warnings are printed too, errors come with the file name and line so IDEs can jump to them
+		if (!result.log.empty()) {
+			fprintf(result.compiled ? stdout : stderr, "%s", result.log.c_str());
+		}
+		if (!result.compiled) {
+			fprintf(stderr, "Error compiling %s\n", shaders[i].c_str());
+			++failed;
+		}
+		else if (result.skipped) {
+			++skipped;
+		}
+		else {
+			++compiled;
+		}
+	}
+	printf("%d shaders compiled, %d up to date, %d failed in %.3f s\n", compiled, skipped, failed, seconds);
+
+	return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+bool writeSPIRV(const std::string &path, const std::vector<uint32_t> &spirv) {
+	// Written to a temporary file first so a failed build never leaves a truncated module behind
+	const std::string temporaryPath = path + ".tmp";
+	FILE *file = fopen(temporaryPath.c_str(), "wb");
+	if (!file) {
+		return false;
+	}
+	const bool written = fwrite(spirv.data(), sizeof(uint32_t), spirv.size(), file) == spirv.size();
+	fclose(file);
+
+	std::error_code error;
+	if (written) {
+		std::filesystem::rename(temporaryPath, path, error);
+	}
+	if (!written || error) {
+		std::filesystem::remove(temporaryPath, error);
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,213 @@
+#include "shared/CommandLine.h"
+#include "shared/ShaderCompiler.h"
+#include "shared/SoftwareRasterizer.h"
+
+#include <glm/glm.hpp>
+#include <glm/ext.hpp>
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "stb_image.h"
+#include "stb/stb_image_write.h"
+
+// Renders the cube of example 04 or 05 on the CPU with SoftwareRasterizer, without a GPU or an OpenGL context.
+// The cube is read from the tables of the vertex shaders of the examples and its MVP is built like their
+// PerFrameData, at a frame of a run with a fixed time step. So the image can be checked against a GL capture of
+// the same frame, or stand in for one as a golden image on machines without a GPU:
+//
+//   Example05_Release --headless --time-step 0.0166667 --single-pass-wireframe --frames 61 --capture gl --capture-first 60 --capture-last 60
+//   SoftRaster_Release --example 05 --frame 60 --time-step 0.0166667 --single-pass-wireframe --reference gl_000060.png
+//
+// Usage: SoftRaster [--example 04|05] [--frame N] [--time-step S] [--width W] [--height H] [--single-pass-wireframe]
+//                   [--output <file.png>] [--reference <file.png>] [--tolerance N] [--max-mismatch P] [--iterations N] [--threads N]
+// --time-step defaults to 1/60 like in the examples. Images are written bottom row first, like GLFrameCapture writes them.
+// With --reference returns EXIT_FAILURE when more than P percent (0.5 by default) of the pixels differ from it by more
+// than N (16 by default) in any channel. The two-pass GL_LINE wireframe isn't reproduced, compare single-pass captures.
+// --iterations draws the frame N times and prints how long it takes.
+
+using glm::mat4;
+using glm::vec2;
+using glm::vec3;
+using glm::vec4;
+using Clock = std::chrono::steady_clock;
+
+double getMilliseconds(Clock::time_point start) {
+	return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// Reads the numbers of the GLSL array called name in source, skipping comments and the vecN constructors around them.
+// Fails unless there are exactly count of them
+bool readShaderTable(const std::string &source, const char *name, size_t count, std::vector<float> &values) {
+	const size_t declaration = source.find(std::string(" ") + name + "[");
+	const size_t start = declaration == std::string::npos ? std::string::npos : source.find('(', declaration);
+	const size_t end = start == std::string::npos ? std::string::npos : source.find(");", start);
+	if (end == std::string::npos) {
+		return false;
+	}
+	values.clear();
+	size_t i = start + 1;
+	while (i < end) {
+		const char c = source[i];
+		if (c == '/' && source[i + 1] == '/') {
+			i = std::min(source.find('\n', i), end);
+		}
+		else if (isalpha(c) || c == '_') {
+			while (i < end && (isalnum(source[i]) || source[i] == '_')) {
+				++i;
+			}
+		}
+		else if (isdigit(c) || c == '-' || c == '.') {
+			char *next;
+			values.push_back(strtof(source.c_str() + i, &next));
+			i = std::max<size_t>(next - source.c_str(), i + 1);
+		}
+		else {
+			++i;
+		}
+	}
+	return values.size() == count;
+}
+
+// What the vertex shader of each example outputs for every gl_VertexID. The cube is read from the tables of the
+// shader itself so the two can't diverge. Example 05 multiplies the texture by white
+bool getCubeVertices(const char *shaderFileName, bool textured, std::vector<SoftwareRasterizer::Vertex> &vertices) {
+	std::string source;
+	std::vector<float> positions, colors, texCoords, indices;
+	if (!readShaderFile(shaderFileName, source) ||
+		!readShaderTable(source, "pos", 8 * 3, positions) ||
+		!readShaderTable(source, "indices", 36, indices) ||
+		(textured ? !readShaderTable(source, "tc", 6 * 2, texCoords) : !readShaderTable(source, "col", 8 * 3, colors))) {
+		fprintf(stderr, "Can't read the cube from %s\n", shaderFileName);
+		return false;
+	}
+
+	vertices.clear();
+	for (int i = 0; i < 36; ++i) {
+		const int index = (int)indices[i];
+		if (index < 0 || index >= 8) {
+			fprintf(stderr, "Index %d out of range in %s\n", index, shaderFileName);
+			return false;
+		}
+		vertices.push_back({
+			.position = vec3(positions[index * 3], positions[index * 3 + 1], positions[index * 3 + 2]),
+			.color = textured ? vec3(1.0f) : vec3(colors[index * 3], colors[index * 3 + 1], colors[index * 3 + 2]),
+			.uv = textured ? vec2(texCoords[i % 6 * 2], texCoords[i % 6 * 2 + 1]) : vec2(0.0f)
+		});
+	}
+	return true;
+}
+
+bool loadTexture(const char *fileName, SoftwareRasterizer::Texture &texture) {
+	int comp;
+	uint8_t *pixels = stbi_load(fileName, &texture.width, &texture.height, &comp, 4);
+	if (!pixels) {
+		fprintf(stderr, "Can't load %s\n", fileName);
+		return false;
+	}
+	texture.pixels.assign(pixels, pixels + (size_t)texture.width * texture.height * 4);
+	stbi_image_free(pixels);
+	return true;
+}
+
+// Returns the percentage of pixels with a channel that differs by more than tolerance
+double comparePixels(const std::vector<uint8_t> &pixels, const uint8_t *reference, int tolerance, int &maxDifference) {
+	size_t mismatches = 0;
+	maxDifference = 0;
+	for (size_t i = 0; i < pixels.size(); i += 4) {
+		int difference = 0;
+		for (size_t k = 0; k < 4; ++k) {
+			difference = std::max(difference, abs((int)pixels[i + k] - (int)reference[i + k]));
+		}
+		maxDifference = std::max(maxDifference, difference);
+		if (difference > tolerance) {
+			++mismatches;
+		}
+	}
+	return 100.0 * mismatches / (pixels.size() / 4);
+}
+
+int main(int argc, char **argv) {
+	CommandLine commandLine(argc, argv);
+	const std::string example = commandLine.getString("example", "04");
+	if (example != "04" && example != "05") {
+		fprintf(stderr, "Usage: SoftRaster [--example 04|05] [--frame N] [--time-step S] [--width W] [--height H] [--single-pass-wireframe]\n"
+			"                  [--output <file.png>] [--reference <file.png>] [--tolerance N] [--max-mismatch P] [--iterations N] [--threads N]\n");
+		return EXIT_FAILURE;
+	}
+	const int width = (int)std::max<int64_t>(1, commandLine.getInt("width", 1920));
+	const int height = (int)std::max<int64_t>(1, commandLine.getInt("height", 1080));
+	const int64_t frame = std::max<int64_t>(0, commandLine.getInt("frame", 0));
+	const double timeStep = commandLine.getDouble("time-step", 1.0 / 60.0);
+	const int iterations = (int)std::max<int64_t>(1, commandLine.getInt("iterations", 1));
+	const std::string output = commandLine.getString("output", "SoftRaster_" + example + ".png");
+
+	SoftwareRasterizer::Texture texture;
+	const bool textured = example == "05";
+	if (textured && !loadTexture("data/ch2_sample3_STB.jpg", texture)) {
+		return EXIT_FAILURE;
+	}
+	std::vector<SoftwareRasterizer::Vertex> vertices;
+	if (!getCubeVertices(textured ? "data/shaders/05_STB.vert" : "data/shaders/04_SingleBuffer.vert", textured, vertices)) {
+		return EXIT_FAILURE;
+	}
+
+	// The same matrices draw() builds, with the time GLApp::getTime() returns at this frame
+	const float time = (float)(frame * timeStep);
+	const mat4 m = glm::rotate(glm::translate(mat4(1.0f), vec3(0.0f, 0.0f, -3.5f)), time, vec3(1.0f, 1.0f, 1.0f));
+	const mat4 p = glm::perspective(45.0f, width / (float)height, 0.1f, 1000.0f);
+	const SoftwareRasterizer::DrawState state = {
+		.mvp = p * m,
+		.texture = textured ? &texture : nullptr,
+		.wireframe = commandLine.hasOption("single-pass-wireframe")
+	};
+
+	SoftwareRasterizer rasterizer(width, height, (unsigned int)std::max<int64_t>(0, commandLine.getInt("threads", 0)));
+	std::vector<double> times;
+	for (int i = 0; i < iterations; ++i) {
+		const Clock::time_point start = Clock::now();
+		rasterizer.clear(vec4(0.0f));
+		rasterizer.drawTriangles(state, vertices.data(), (uint32_t)vertices.size());
+		times.push_back(getMilliseconds(start));
+	}
+	std::sort(times.begin(), times.end());
+	printf("Example %s frame %lld at %dx%d: min %.3f ms, median %.3f ms over %d iterations\n", example.c_str(), (long long)frame,
+		width, height, times.front(), times[times.size() / 2], iterations);
+
+	std::vector<uint8_t> pixels;
+	rasterizer.getPixels(pixels);
+	if (!stbi_write_png(output.c_str(), width, height, 4, pixels.data(), 0)) {
+		fprintf(stderr, "Can't write %s\n", output.c_str());
+		return EXIT_FAILURE;
+	}
+
+	if (!commandLine.hasOption("reference")) {
+		return EXIT_SUCCESS;
+	}
+	const std::string referencePath = commandLine.getString("reference", "");
+	int referenceWidth, referenceHeight, comp;
+	uint8_t *reference = stbi_load(referencePath.c_str(), &referenceWidth, &referenceHeight, &comp, 4);
+	if (!reference) {
+		fprintf(stderr, "Can't load the reference %s\n", referencePath.c_str());
+		return EXIT_FAILURE;
+	}
+	if (referenceWidth != width || referenceHeight != height) {
+		fprintf(stderr, "The reference is %dx%d, the image %dx%d\n", referenceWidth, referenceHeight, width, height);
+		stbi_image_free(reference);
+		return EXIT_FAILURE;
+	}
+	const int tolerance = (int)commandLine.getInt("tolerance", 16);
+	const double maxMismatch = commandLine.getDouble("max-mismatch", 0.5);
+	int maxDifference;
+	const double mismatch = comparePixels(pixels, reference, tolerance, maxDifference);
+	stbi_image_free(reference);
+
+	const bool passed = mismatch <= maxMismatch;
+	printf("%.3f%% of the pixels differ from %s by more than %d, %.3f%% allowed. Largest difference %d: %s\n",
+		mismatch, referencePath.c_str(), tolerance, maxMismatch, maxDifference, passed ? "OK" : "FAILED");
+	return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,135 @@
+#include "shared/CommandLine.h"
+#include "shared/Mipmaps.h"
+#include "shared/glFramework/GLTextureLoader.h"
+#include "etc2comp/EtcLib/Etc/Etc.h"
+#include "etc2comp/EtcLib/Etc/EtcImage.h"
+#include <gli/gli.hpp>
+#include "stb_image.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Converts source images into ETC2 compressed KTX files with their whole mip chain.
+// GLTextureLoader picks the KTX file up instead of decoding the source image when it exists.
+//
+// Usage: TextureBake --input <image> [--output <file.ktx>]
+//        TextureBake --directory <folder>
+//        [--effort 0-100] [--jobs N] [--mip-filter box|kaiser]
+
+struct BakeSettings {
+	float effort = ETCCOMP_DEFAULT_EFFORT_LEVEL;
+	unsigned int jobs = 1;
+	MipFilter mipFilter = MipFilter::Kaiser;
+};
+
+bool bakeTexture(const std::string&, const std::string&, const BakeSettings&);
+bool isSourceImage(const std::filesystem::path&);
+
+int main(int argc, char **argv) {
+	CommandLine commandLine(argc, argv);
+
+	BakeSettings settings;
+	settings.effort = (float)commandLine.getDouble("effort", ETCCOMP_DEFAULT_EFFORT_LEVEL);
+	settings.jobs = (unsigned int)commandLine.getInt("jobs", std::max(1u, std::thread::hardware_concurrency()));
+	settings.mipFilter = commandLine.getString("mip-filter", "kaiser") == "box" ? MipFilter::Box : MipFilter::Kaiser;
+
+	std::vector<std::string> inputs;
+	if (commandLine.hasOption("input")) {
+		inputs.push_back(commandLine.getString("input", ""));
+	}
+	if (commandLine.hasOption("directory")) {
+		for (const auto &entry : std::filesystem::recursive_directory_iterator(commandLine.getString("directory", "."))) {
+			if (entry.is_regular_file() && isSourceImage(entry.path())) {
+				inputs.push_back(entry.path().string());
+			}
+		}
+	}
+	if (inputs.empty()) {
+		fprintf(stderr, "Usage: TextureBake --input <image> [--output <file.ktx>] | --directory <folder> [--effort 0-100] [--jobs N] [--mip-filter box|kaiser]\n");
+		return EXIT_FAILURE;
+	}
+
+	int failed = 0;
+	for (const std::string &input : inputs) {
+		const std::string output = inputs.size() == 1 && commandLine.hasOption("output") ?
+			commandLine.getString("output", "") : GLTextureLoader::getCompressedPath(input);
+		if (!bakeTexture(input, output, settings)) {
+			++failed;
+		}
+	}
+
+	return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+bool bakeTexture(const std::string &input, const std::string &output, const BakeSettings &settings) {
+	int w, h, comp;
+	uint8_t *pixels = stbi_load(input.c_str(), &w, &h, &comp, 3);
+	if (!pixels) {
+		fprintf(stderr, "Error loading %s: %s\n", input.c_str(), stbi_failure_reason());
+		return false;
+	}
+
+	// The same mip chain the loader would generate at runtime
+	MipChain mipChain;
+	generateMipChain(pixels, w, h, 3, settings.mipFilter, true, mipChain);
+	stbi_image_free(pixels);
+
+	gli::texture2d texture(gli::FORMAT_RGB_ETC2_UNORM_BLOCK8, gli::extent2d(w, h), mipChain.levels.size());
+	int totalTime = 0;
+	for (size_t level = 0; level < mipChain.levels.size(); ++level) {
+		const MipChain::Level &mip = mipChain.levels[level];
+
+		// EtcLib encodes from RGBA floats
+		std::vector<float> rgba((size_t)mip.width * mip.height * 4);
+		const uint8_t *src = mipChain.data.data() + mip.offset;
+		for (size_t i = 0; i < (size_t)mip.width * mip.height; ++i) {
+			rgba[i * 4 + 0] = src[i * 3 + 0] / 255.0f;
+			rgba[i * 4 + 1] = src[i * 3 + 1] / 255.0f;
+			rgba[i * 4 + 2] = src[i * 3 + 2] / 255.0f;
+			rgba[i * 4 + 3] = 1.0f;
+		}
+
+		// EtcLib splits the blocks of the image between `jobs` threads
+		unsigned char *encodingBits = nullptr;
+		unsigned int encodingBitsBytes = 0;
+		unsigned int extendedWidth = 0;
+		unsigned int extendedHeight = 0;
+		int encodingTime = 0;
+		Etc::Encode(rgba.data(), mip.width, mip.height, Etc::Image::Format::RGB8, Etc::ErrorMetric::BT709,
+			settings.effort, settings.jobs, 1024, &encodingBits, &encodingBitsBytes, &extendedWidth, &extendedHeight, &encodingTime);
+		totalTime += encodingTime;
+
+		if (encodingBitsBytes != texture.size(level)) {
+			fprintf(stderr, "Unexpected ETC2 size for %s level %zu: %u bytes instead of %zu\n",
+				input.c_str(), level, encodingBitsBytes, texture.size(level));
+			delete[] encodingBits;
+			return false;
+		}
+		memcpy(texture.data(0, 0, level), encodingBits, encodingBitsBytes);
+		delete[] encodingBits;
+	}
+
+	if (!gli::save_ktx(texture, output)) {
+		fprintf(stderr, "Error saving %s\n", output.c_str());
+		return false;
+	}
+
+	printf("%s -> %s (%dx%d, %zu levels, %zu bytes, %d ms)\n", input.c_str(), output.c_str(), w, h,
+		mipChain.levels.size(), texture.size(), totalTime);
+	return true;
+}
+
+bool isSourceImage(const std::filesystem::path &path) {
+	std::string extension = path.extension().string();
+	for (char &c : extension) {
+		c = (char)tolower(c);
+	}
+	return extension == ".jpg" || extension == ".jpeg" || extension == ".png" || extension == ".tga" || extension == ".bmp";
+}
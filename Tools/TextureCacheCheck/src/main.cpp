@@ -0,0 +1,24 @@
+#include "shared/CommandLine.h"
+#include "shared/TextureCache.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <filesystem>
+#include <string>
+
+// Checks that TextureCache rejects truncated and corrupted entries, so GLTextureLoader decodes the image again
+// instead of reading past the mapping. The entries are written to a scratch directory that is deleted afterwards.
+//
+// Usage: TextureCacheCheck [--directory <folder>]
+// The directory defaults to TextureCacheCheck under the temporary directory. Returns EXIT_FAILURE when a broken
+// entry is accepted or a valid one can't be loaded.
+
+int main(int argc, char **argv) {
+	CommandLine commandLine(argc, argv);
+	const std::string directory = commandLine.getString("directory",
+		(std::filesystem::temp_directory_path() / "TextureCacheCheck").string());
+
+	const bool passed = TextureCache::selfTest(directory);
+	printf("%s\n", passed ? "Every broken entry was rejected" : "FAILED");
+	return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
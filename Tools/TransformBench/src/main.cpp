@@ -0,0 +1,134 @@
+#include "shared/CommandLine.h"
+#include "shared/scene/TransformBatch.h"
+
+#include <glm/glm.hpp>
+#include <glm/ext.hpp>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <random>
+#include <vector>
+
+// Times computeTransforms against the same matrices computed with glm one object at a time, the way draw() builds
+// them in the examples, and validates every matrix of the batch against the glm ones. Runs without a GPU.
+//
+// Usage: TransformBench [--count N] [--iterations N] [--tolerance T]
+// --count is the number of transforms (100000 by default), each pass over all of them is repeated --iterations times
+// (100 by default). Returns EXIT_FAILURE when an element differs from glm by more than T (1e-4 by default), relative
+// to the element when it's larger than 1.
+
+using glm::mat4;
+using glm::quat;
+using glm::vec3;
+using Clock = std::chrono::steady_clock;
+
+// How the transforms of each object are usually kept, and what the glm version reads
+struct Transform {
+	vec3 position;
+	quat rotation;
+	vec3 scale;
+};
+
+double getMilliseconds(Clock::time_point start) {
+	return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// Returns the sorted time of every iteration
+std::vector<double> measure(int iterations, const std::function<void()> &pass) {
+	std::vector<double> times;
+	for (int i = 0; i < iterations; ++i) {
+		const Clock::time_point start = Clock::now();
+		pass();
+		times.push_back(getMilliseconds(start));
+	}
+	std::sort(times.begin(), times.end());
+	return times;
+}
+
+void printTimes(const char *name, const std::vector<double> &times, size_t count, double baseline) {
+	const double median = times[times.size() / 2];
+	printf("%-24s %12.3f %12.3f %14.2f %10.2fx\n", name, times.front(), median, median * 1e6 / count, baseline / median);
+}
+
+// The largest difference between an element of the matrices and the reference ones, relative to the element when larger than 1
+float getMaxError(const std::vector<mat4> &matrices, const std::vector<mat4> &reference) {
+	float maxError = 0.0f;
+	for (size_t i = 0; i < matrices.size(); ++i) {
+		for (int column = 0; column < 4; ++column) {
+			for (int row = 0; row < 4; ++row) {
+				const float expected = reference[i][column][row];
+				const float error = fabsf(matrices[i][column][row] - expected) / std::max(1.0f, fabsf(expected));
+				// NaN fails the validation too
+				maxError = error > maxError || error != error ? error : maxError;
+			}
+		}
+	}
+	return maxError;
+}
+
+int main(int argc, char **argv) {
+	CommandLine commandLine(argc, argv);
+	const size_t count = (size_t)std::max<int64_t>(1, commandLine.getInt("count", 100000));
+	const int iterations = (int)std::max<int64_t>(1, commandLine.getInt("iterations", 100));
+	const float tolerance = (float)commandLine.getDouble("tolerance", 1e-4);
+
+	// Objects scattered around the origin with random rotations and scales, seen by a camera like the one of example 06
+	std::mt19937 random(1234);
+	std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+	std::uniform_real_distribution<float> scale(0.5f, 2.0f);
+	std::vector<Transform> transforms(count);
+	TransformBatch batch;
+	batch.resize(count);
+	for (size_t i = 0; i < count; ++i) {
+		vec3 axis(unit(random), unit(random), unit(random));
+		axis = glm::length(axis) > 1e-3f ? glm::normalize(axis) : vec3(0.0f, 1.0f, 0.0f);
+		transforms[i] = {
+			.position = vec3(position(random), position(random), position(random)),
+			.rotation = glm::angleAxis(unit(random) * 3.14159265f, axis),
+			.scale = vec3(scale(random), scale(random), scale(random))
+		};
+		batch.set(i, transforms[i].position, transforms[i].rotation, transforms[i].scale);
+	}
+	const mat4 viewProj = glm::perspective(45.0f, 16.0f / 9.0f, 0.1f, 1000.0f) *
+		glm::lookAt(vec3(0.0f, 100.0f, 250.0f), vec3(0.0f), vec3(0.0f, 1.0f, 0.0f));
+
+	std::vector<mat4> reference(count);
+	std::vector<mat4> matrices(count);
+	std::vector<mat4> models(count);
+	const std::vector<double> glmTimes = measure(iterations, [&]() {
+		for (size_t i = 0; i < count; ++i) {
+			const Transform &t = transforms[i];
+			reference[i] = viewProj * glm::translate(mat4(1.0f), t.position) * glm::mat4_cast(t.rotation) * glm::scale(mat4(1.0f), t.scale);
+		}
+	});
+	const std::vector<double> batchTimes = measure(iterations, [&]() {
+		computeTransforms(batch, viewProj, matrices.data());
+	});
+	const float error = getMaxError(matrices, reference);
+	const std::vector<double> batchModelTimes = measure(iterations, [&]() {
+		computeTransforms(batch, viewProj, matrices.data(), models.data());
+	});
+	// The models against a parent of identity, what the examples upload
+	std::vector<mat4> referenceModels(count);
+	for (size_t i = 0; i < count; ++i) {
+		const Transform &t = transforms[i];
+		referenceModels[i] = glm::translate(mat4(1.0f), t.position) * glm::mat4_cast(t.rotation) * glm::scale(mat4(1.0f), t.scale);
+	}
+	const float modelError = getMaxError(models, referenceModels);
+
+	printf("%zu transforms, %d iterations, computeTransforms uses %s\n", count, iterations, getTransformsCodePath());
+	printf("%-24s %12s %12s %14s %11s\n", "Path", "Min (ms)", "Median (ms)", "ns/transform", "Speedup");
+	const double baseline = glmTimes[glmTimes.size() / 2];
+	printTimes("glm", glmTimes, count, baseline);
+	printTimes("computeTransforms", batchTimes, count, baseline);
+	printTimes("computeTransforms+models", batchModelTimes, count, baseline);
+
+	const bool passed = error <= tolerance && modelError <= tolerance;
+	printf("Largest error against glm %g for the matrices and %g for the models, %g allowed: %s\n", error, modelError, tolerance,
+		passed ? "OK" : "FAILED");
+	return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,15 @@
+#version 460 core
+layout (location=0) in vec3 color;
+layout (location=1) in vec3 barycoords;
+layout (location=2) flat in int drawWireframe;
+layout (location=0) out vec4 out_FragColor;
+// 0 on the edges of the triangle and 1 a pixel away from them. A barycentric coordinate is 0 along the opposite
+// edge and fwidth tells how much it changes from one pixel to the next, which turns it into a distance in pixels
+float edgeFactor() {
+	vec3 d = fwidth(barycoords);
+	vec3 a = smoothstep(vec3(0.0), d, barycoords);
+	return min(min(a.x, a.y), a.z);
+}
+void main() {
+	out_FragColor = vec4(drawWireframe > 0 ? mix(vec3(1.0), color, edgeFactor()) : color, 1.0);
+}
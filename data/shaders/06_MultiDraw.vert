@@ -0,0 +1,19 @@
+#version 460 core
+layout (std140, binding=0) uniform PerFrameData {
+	uniform mat4 viewProj;
+};
+// One model matrix per draw of the glMultiDrawElementsIndirect call, see GLBatchRenderer
+layout (std430, binding=1) readonly buffer DrawData {
+	mat4 models[];
+};
+layout (location=0) in vec3 pos;
+layout (location=1) in vec3 normal;
+layout (location=2) in vec2 uv;
+layout (location=0) out vec3 color;
+void main() {
+	mat4 model = models[gl_DrawID];
+	gl_Position = viewProj * model * vec4(pos, 1.0);
+	// A directional light from above the camera
+	vec3 n = normalize(mat3(model) * normal);
+	color = vec3(0.2) + vec3(0.8) * max(dot(n, normalize(vec3(0.3, 1.0, 0.6))), 0.0);
+}
@@ -0,0 +1,42 @@
+#include "shared/CommandLine.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+CommandLine::CommandLine(int argc, char **argv) {
+	for (int i = 1; i < argc; ++i) {
+		const std::string arg = argv[i];
+		if (arg.rfind("--", 0) != 0) {
+			fprintf(stderr, "Ignoring unknown argument: %s\n", argv[i]);
+			continue;
+		}
+
+		// An option followed by something that isn't another option takes it as its value
+		const std::string name = arg.substr(2);
+		if (i + 1 < argc && std::string(argv[i + 1]).rfind("--", 0) != 0) {
+			options_[name] = argv[++i];
+		}
+		else {
+			options_[name] = "";
+		}
+	}
+}
+
+bool CommandLine::hasOption(const std::string &name) const {
+	return options_.find(name) != options_.end();
+}
+
+std::string CommandLine::getString(const std::string &name, const std::string &defaultValue) const {
+	auto option = options_.find(name);
+	return option != options_.end() ? option->second : defaultValue;
+}
+
+int64_t CommandLine::getInt(const std::string &name, int64_t defaultValue) const {
+	auto option = options_.find(name);
+	return option != options_.end() && !option->second.empty() ? strtoll(option->second.c_str(), nullptr, 10) : defaultValue;
+}
+
+double CommandLine::getDouble(const std::string &name, double defaultValue) const {
+	auto option = options_.find(name);
+	return option != options_.end() && !option->second.empty() ? strtod(option->second.c_str(), nullptr) : defaultValue;
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <stdint.h>
+#include <map>
+#include <string>
+
+// Parses options like "--name value" and flags like "--name" from the command line
+class CommandLine {
+public:
+	CommandLine(int argc, char **argv);
+
+	bool hasOption(const std::string &name) const;
+	std::string getString(const std::string &name, const std::string &defaultValue) const;
+	int64_t getInt(const std::string &name, int64_t defaultValue) const;
+	double getDouble(const std::string &name, double defaultValue) const;
+
+private:
+	std::map<std::string, std::string> options_;
+};
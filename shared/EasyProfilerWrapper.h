@@ -0,0 +1,22 @@
+#pragma once
+
+// Include this instead of easy/profiler.h. The instrumentation macros compile to nothing when the
+// project is built without BUILD_WITH_EASY_PROFILER, so code can use them unconditionally.
+#if BUILD_WITH_EASY_PROFILER
+
+#include <easy/profiler.h>
+
+#else
+
+#define EASY_FUNCTION(...)
+#define EASY_BLOCK(...)
+#define EASY_NONSCOPED_BLOCK(...)
+#define EASY_END_BLOCK
+#define EASY_EVENT(...)
+#define EASY_THREAD(...)
+#define EASY_THREAD_SCOPE(...)
+#define EASY_MAIN_THREAD
+#define EASY_PROFILER_ENABLE
+#define EASY_PROFILER_DISABLE
+
+#endif
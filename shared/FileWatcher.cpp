@@ -0,0 +1,128 @@
+#include "shared/FileWatcher.h"
+
+#include <stdio.h>
+#include <algorithm>
+#include <filesystem>
+
+#if defined(__linux__)
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#endif
+
+#if defined(__linux__)
+
+// Editors save either by writing the file in place or by writing a new one and renaming it over the old one
+static const uint32_t kWatchMask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE;
+
+FileWatcher::FileWatcher(const std::string &directory)
+	: directory_(directory)
+	, fd_(inotify_init1(IN_NONBLOCK | IN_CLOEXEC)) {
+	if (fd_ < 0) {
+		fprintf(stderr, "Can't watch %s: %s\n", directory.c_str(), strerror(errno));
+		return;
+	}
+
+	// inotify isn't recursive so every subfolder gets its own watch
+	addWatch(directory);
+	std::error_code error;
+	for (const auto &entry : std::filesystem::recursive_directory_iterator(directory, error)) {
+		if (entry.is_directory()) {
+			addWatch(entry.path().string());
+		}
+	}
+}
+
+FileWatcher::~FileWatcher() {
+	if (fd_ >= 0) {
+		close(fd_);
+	}
+}
+
+void FileWatcher::addWatch(const std::string &directory) {
+	const int wd = inotify_add_watch(fd_, directory.c_str(), kWatchMask);
+	if (wd < 0) {
+		fprintf(stderr, "Can't watch %s: %s\n", directory.c_str(), strerror(errno));
+		return;
+	}
+	watches_.push_back({ wd, directory });
+}
+
+std::vector<std::string> FileWatcher::poll() {
+	std::vector<std::string> changed;
+	if (fd_ < 0) {
+		return changed;
+	}
+
+	alignas(struct inotify_event) char buffer[4096];
+	for (;;) {
+		const ssize_t size = read(fd_, buffer, sizeof(buffer));
+		if (size <= 0) {
+			break;
+		}
+		for (ssize_t offset = 0; offset < size;) {
+			const struct inotify_event *event = (const struct inotify_event*)(buffer + offset);
+			offset += sizeof(struct inotify_event) + event->len;
+
+			const auto watch = std::find_if(watches_.begin(), watches_.end(), [&](const auto &w) { return w.first == event->wd; });
+			if (event->len == 0 || watch == watches_.end()) {
+				continue;
+			}
+			const std::string path = (std::filesystem::path(watch->second) / event->name).string();
+			if (event->mask & IN_ISDIR) {
+				if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+					addWatch(path);
+				}
+			}
+			// A file being created is reported again when it's closed after writing
+			else if (!(event->mask & IN_CREATE) && std::find(changed.begin(), changed.end(), path) == changed.end()) {
+				changed.push_back(path);
+			}
+		}
+	}
+	return changed;
+}
+
+#else
+
+FileWatcher::FileWatcher(const std::string &directory)
+	: directory_(directory)
+	, lastPoll_(std::chrono::steady_clock::now()) {
+	// The first poll only reports what changes from now on
+	std::error_code error;
+	for (const auto &entry : std::filesystem::recursive_directory_iterator(directory, error)) {
+		if (entry.is_regular_file()) {
+			times_[entry.path().string()] = entry.last_write_time(error);
+		}
+	}
+}
+
+FileWatcher::~FileWatcher() {
+}
+
+std::vector<std::string> FileWatcher::poll() {
+	std::vector<std::string> changed;
+	const auto now = std::chrono::steady_clock::now();
+	if (now - lastPoll_ < std::chrono::milliseconds(500)) {
+		return changed;
+	}
+	lastPoll_ = now;
+
+	std::error_code error;
+	for (const auto &entry : std::filesystem::recursive_directory_iterator(directory_, error)) {
+		if (!entry.is_regular_file()) {
+			continue;
+		}
+		const std::string path = entry.path().string();
+		const auto time = entry.last_write_time(error);
+		auto known = times_.find(path);
+		if (known == times_.end() || known->second != time) {
+			times_[path] = time;
+			changed.push_back(path);
+		}
+	}
+	return changed;
+}
+
+#endif
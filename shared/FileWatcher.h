@@ -0,0 +1,39 @@
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#if !defined(__linux__)
+#include <chrono>
+#include <filesystem>
+#include <unordered_map>
+#endif
+
+// Reports the files written, created or moved into a folder or any of its subfolders.
+// On Linux it's driven by inotify so polling is a single non-blocking read. Elsewhere it compares
+// modification times, walking the folder at most twice a second.
+class FileWatcher {
+public:
+	explicit FileWatcher(const std::string &directory);
+	~FileWatcher();
+
+	FileWatcher(const FileWatcher&) = delete;
+	FileWatcher& operator=(const FileWatcher&) = delete;
+
+	// Never blocks. Returns every file that changed since the last call, each one once
+	std::vector<std::string> poll();
+
+private:
+	std::string directory_;
+#if defined(__linux__)
+	void addWatch(const std::string &directory);
+
+	int fd_ = -1;
+	// The folder of every inotify watch descriptor, events only carry the name of the file
+	std::vector<std::pair<int, std::string>> watches_;
+#else
+	std::unordered_map<std::string, std::filesystem::file_time_type> times_;
+	std::chrono::steady_clock::time_point lastPoll_;
+#endif
+};
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+static const uint64_t kHashSeed = 14695981039346656037ull;
+
+// 64 bit FNV-1a. Not cryptographic but good enough to key caches by their contents.
+// Pass the result of a previous call as seed to hash several buffers together
+inline uint64_t hashBytes(const void *data, size_t size, uint64_t seed = kHashSeed) {
+	const uint8_t *bytes = (const uint8_t*)data;
+	uint64_t hash = seed;
+	for (size_t i = 0; i < size; ++i) {
+		hash ^= bytes[i];
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+template<typename T>
+uint64_t hashValue(const T &value, uint64_t seed = kHashSeed) {
+	return hashBytes(&value, sizeof(T), seed);
+}
@@ -0,0 +1,75 @@
+#include "shared/MappedFile.h"
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(_WIN32)
+
+MappedFile::MappedFile(const std::string &path) {
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE) {
+		return;
+	}
+	file_ = file;
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+		return;
+	}
+
+	mapping_ = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!mapping_) {
+		return;
+	}
+
+	data_ = (const uint8_t*)MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0);
+	size_ = data_ ? (size_t)size.QuadPart : 0;
+}
+
+MappedFile::~MappedFile() {
+	if (data_) {
+		UnmapViewOfFile(data_);
+	}
+	if (mapping_) {
+		CloseHandle(mapping_);
+	}
+	if (file_) {
+		CloseHandle(file_);
+	}
+}
+
+#else
+
+MappedFile::MappedFile(const std::string &path) {
+	const int fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0) {
+		return;
+	}
+
+	struct stat info;
+	if (fstat(fd, &info) == 0 && info.st_size > 0) {
+		void *data = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (data != MAP_FAILED) {
+			data_ = (const uint8_t*)data;
+			size_ = (size_t)info.st_size;
+		}
+	}
+	// The mapping keeps its own reference to the file
+	close(fd);
+}
+
+MappedFile::~MappedFile() {
+	if (data_) {
+		munmap((void*)data_, size_);
+	}
+}
+
+#endif
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+// Maps a whole file read-only in memory. Reads are served straight from the OS page cache
+// so there is no copy until someone touches the data
+class MappedFile {
+public:
+	explicit MappedFile(const std::string &path);
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	bool isValid() const { return data_ != nullptr; }
+	const uint8_t *getData() const { return data_; }
+	size_t getSize() const { return size_; }
+
+private:
+	const uint8_t *data_ = nullptr;
+	size_t size_ = 0;
+#if defined(_WIN32)
+	void *file_ = nullptr;
+	void *mapping_ = nullptr;
+#endif
+};
@@ -0,0 +1,264 @@
+#include "shared/Mipmaps.h"
+
+#include <algorithm>
+#include <math.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define MIPMAPS_AVX2 1
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MIPMAPS_SSE2 1
+#endif
+
+// Levels are filtered as RGBA floats so every pixel fills exactly one SSE register
+static const int kWorkComponents = 4;
+static const int kKaiserTaps = 8;
+// Resolution of the table used to go back from linear to sRGB
+static const int kLinearToSRGBSize = 4096;
+
+namespace {
+
+struct ColorTables {
+	float sRGBToLinear[256];
+	uint8_t linearToSRGB[kLinearToSRGBSize];
+
+	ColorTables() {
+		for (int i = 0; i < 256; ++i) {
+			const float c = i / 255.0f;
+			sRGBToLinear[i] = c <= 0.04045f ? c / 12.92f : powf((c + 0.055f) / 1.055f, 2.4f);
+		}
+		for (int i = 0; i < kLinearToSRGBSize; ++i) {
+			const float l = i / (float)(kLinearToSRGBSize - 1);
+			const float c = l <= 0.0031308f ? l * 12.92f : 1.055f * powf(l, 1.0f / 2.4f) - 0.055f;
+			linearToSRGB[i] = (uint8_t)(std::clamp(c, 0.0f, 1.0f) * 255.0f + 0.5f);
+		}
+	}
+};
+
+const ColorTables &getColorTables() {
+	static const ColorTables tables;
+	return tables;
+}
+
+float besselI0(float x) {
+	// Power series of the modified Bessel function of the first kind, converges quickly for our beta
+	float sum = 1.0f;
+	float term = 1.0f;
+	for (int k = 1; k < 20; ++k) {
+		term *= (x / (2.0f * k)) * (x / (2.0f * k));
+		sum += term;
+	}
+	return sum;
+}
+
+// Weights of a Kaiser windowed sinc that halves the resolution. Tap k reads the source pixel 2x - 3 + k
+void computeKaiserWeights(float weights[kKaiserTaps]) {
+	const float kBeta = 4.0f;
+	const float kRadius = 2.0f;
+	const float pi = 3.14159265358979f;
+	float sum = 0.0f;
+	for (int k = 0; k < kKaiserTaps; ++k) {
+		// Distance from the source pixel center to the destination pixel center, in destination pixels
+		const float t = (k - 3.5f) * 0.5f;
+		const float sinc = t == 0.0f ? 1.0f : sinf(pi * t) / (pi * t);
+		const float r = t / kRadius;
+		const float window = besselI0(kBeta * sqrtf(std::max(0.0f, 1.0f - r * r))) / besselI0(kBeta);
+		weights[k] = sinc * window;
+		sum += weights[k];
+	}
+	for (int k = 0; k < kKaiserTaps; ++k) {
+		weights[k] /= sum;
+	}
+}
+
+void toLinear(const uint8_t *pixels, size_t numPixels, int numComponents, bool isSRGB, float *out) {
+	const ColorTables &tables = getColorTables();
+	for (size_t i = 0; i < numPixels; ++i) {
+		const uint8_t *src = pixels + i * numComponents;
+		float *dst = out + i * kWorkComponents;
+		for (int k = 0; k < 3; ++k) {
+			dst[k] = isSRGB ? tables.sRGBToLinear[src[k]] : src[k] / 255.0f;
+		}
+		dst[3] = numComponents == 4 ? src[3] / 255.0f : 1.0f;
+	}
+}
+
+void fromLinear(const float *in, size_t numPixels, int numComponents, bool isSRGB, uint8_t *pixels) {
+	const ColorTables &tables = getColorTables();
+	for (size_t i = 0; i < numPixels; ++i) {
+		const float *src = in + i * kWorkComponents;
+		uint8_t *dst = pixels + i * numComponents;
+		for (int k = 0; k < numComponents; ++k) {
+			const float value = std::clamp(src[k], 0.0f, 1.0f);
+			dst[k] = isSRGB && k < 3 ?
+				tables.linearToSRGB[(int)(value * (kLinearToSRGBSize - 1) + 0.5f)] :
+				(uint8_t)(value * 255.0f + 0.5f);
+		}
+	}
+}
+
+// dst[i] += weight * src[i]
+void addScaledRow(float *dst, const float *src, float weight, size_t count) {
+	size_t i = 0;
+#if MIPMAPS_AVX2
+	const __m256 w8 = _mm256_set1_ps(weight);
+	for (; i + 8 <= count; i += 8) {
+		_mm256_storeu_ps(dst + i, _mm256_add_ps(_mm256_loadu_ps(dst + i), _mm256_mul_ps(w8, _mm256_loadu_ps(src + i))));
+	}
+#endif
+#if MIPMAPS_SSE2
+	const __m128 w4 = _mm_set1_ps(weight);
+	for (; i + 4 <= count; i += 4) {
+		_mm_storeu_ps(dst + i, _mm_add_ps(_mm_loadu_ps(dst + i), _mm_mul_ps(w4, _mm_loadu_ps(src + i))));
+	}
+#endif
+	for (; i < count; ++i) {
+		dst[i] += weight * src[i];
+	}
+}
+
+// Averages the 2x2 blocks of two source rows into one destination row
+void boxRow(const float *row0, const float *row1, int srcWidth, float *dst, int dstWidth) {
+	int x = 0;
+	if (srcWidth >= 2) {
+#if MIPMAPS_AVX2
+		// Two destination pixels per iteration. After adding both rows we have [p0 p1] [p2 p3] and
+		// we shuffle the 128 bit lanes to [p0 p2] + [p1 p3]
+		const __m256 quarter8 = _mm256_set1_ps(0.25f);
+		for (; x + 2 <= dstWidth; x += 2) {
+			const float *a = row0 + x * 2 * kWorkComponents;
+			const float *b = row1 + x * 2 * kWorkComponents;
+			const __m256 v01 = _mm256_add_ps(_mm256_loadu_ps(a), _mm256_loadu_ps(b));
+			const __m256 v23 = _mm256_add_ps(_mm256_loadu_ps(a + 8), _mm256_loadu_ps(b + 8));
+			const __m256 even = _mm256_permute2f128_ps(v01, v23, 0x20);
+			const __m256 odd = _mm256_permute2f128_ps(v01, v23, 0x31);
+			_mm256_storeu_ps(dst + x * kWorkComponents, _mm256_mul_ps(_mm256_add_ps(even, odd), quarter8));
+		}
+#endif
+#if MIPMAPS_SSE2
+		const __m128 quarter4 = _mm_set1_ps(0.25f);
+		for (; x < dstWidth; ++x) {
+			const float *a = row0 + x * 2 * kWorkComponents;
+			const float *b = row1 + x * 2 * kWorkComponents;
+			const __m128 sum = _mm_add_ps(_mm_add_ps(_mm_loadu_ps(a), _mm_loadu_ps(a + 4)), _mm_add_ps(_mm_loadu_ps(b), _mm_loadu_ps(b + 4)));
+			_mm_storeu_ps(dst + x * kWorkComponents, _mm_mul_ps(sum, quarter4));
+		}
+#endif
+	}
+
+	// Scalar path, also used when the source is a single pixel wide column
+	for (; x < dstWidth; ++x) {
+		const int x0 = x * 2;
+		const int x1 = std::min(x0 + 1, srcWidth - 1);
+		for (int k = 0; k < kWorkComponents; ++k) {
+			dst[x * kWorkComponents + k] = 0.25f * (
+				row0[x0 * kWorkComponents + k] + row0[x1 * kWorkComponents + k] +
+				row1[x0 * kWorkComponents + k] + row1[x1 * kWorkComponents + k]);
+		}
+	}
+}
+
+void downsampleBox(const float *src, int srcWidth, int srcHeight, float *dst, int dstWidth, int dstHeight) {
+	for (int y = 0; y < dstHeight; ++y) {
+		const float *row0 = src + (size_t)(y * 2) * srcWidth * kWorkComponents;
+		const float *row1 = src + (size_t)std::min(y * 2 + 1, srcHeight - 1) * srcWidth * kWorkComponents;
+		boxRow(row0, row1, srcWidth, dst + (size_t)y * dstWidth * kWorkComponents, dstWidth);
+	}
+}
+
+// Filters one row horizontally halving its width. Borders are clamped
+void kaiserRow(const float *src, int srcWidth, float *dst, int dstWidth, const float weights[kKaiserTaps]) {
+	for (int x = 0; x < dstWidth; ++x) {
+		const int first = x * 2 - 3;
+#if MIPMAPS_SSE2
+		__m128 acc = _mm_setzero_ps();
+		for (int k = 0; k < kKaiserTaps; ++k) {
+			const int i = std::clamp(first + k, 0, srcWidth - 1);
+			acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(weights[k]), _mm_loadu_ps(src + i * kWorkComponents)));
+		}
+		_mm_storeu_ps(dst + x * kWorkComponents, acc);
+#else
+		float acc[kWorkComponents] = {};
+		for (int k = 0; k < kKaiserTaps; ++k) {
+			const int i = std::clamp(first + k, 0, srcWidth - 1);
+			for (int c = 0; c < kWorkComponents; ++c) {
+				acc[c] += weights[k] * src[i * kWorkComponents + c];
+			}
+		}
+		for (int c = 0; c < kWorkComponents; ++c) {
+			dst[x * kWorkComponents + c] = acc[c];
+		}
+#endif
+	}
+}
+
+void downsampleKaiser(const float *src, int srcWidth, int srcHeight, float *dst, int dstWidth, int dstHeight, std::vector<float> &scratch) {
+	float weights[kKaiserTaps];
+	computeKaiserWeights(weights);
+
+	// The filter is separable so we first halve the width of every row and then the height of every column
+	const size_t dstRowSize = (size_t)dstWidth * kWorkComponents;
+	scratch.resize(dstRowSize * srcHeight);
+	for (int y = 0; y < srcHeight; ++y) {
+		kaiserRow(src + (size_t)y * srcWidth * kWorkComponents, srcWidth, scratch.data() + y * dstRowSize, dstWidth, weights);
+	}
+
+	for (int y = 0; y < dstHeight; ++y) {
+		float *dstRow = dst + y * dstRowSize;
+		std::fill(dstRow, dstRow + dstRowSize, 0.0f);
+		const int first = y * 2 - 3;
+		for (int k = 0; k < kKaiserTaps; ++k) {
+			const int i = std::clamp(first + k, 0, srcHeight - 1);
+			addScaledRow(dstRow, scratch.data() + i * dstRowSize, weights[k], dstRowSize);
+		}
+	}
+}
+
+}
+
+uint32_t getNumMipLevels(int width, int height) {
+	uint32_t levels = 1;
+	while ((width | height) >> levels) {
+		++levels;
+	}
+	return levels;
+}
+
+void generateMipChain(const uint8_t *pixels, int width, int height, int numComponents, MipFilter filter, bool isSRGB, MipChain &chain) {
+	const uint32_t numLevels = getNumMipLevels(width, height);
+	chain.numComponents = numComponents;
+	chain.levels.clear();
+
+	size_t totalSize = 0;
+	for (uint32_t level = 0; level < numLevels; ++level) {
+		const int w = std::max(1, width >> level);
+		const int h = std::max(1, height >> level);
+		const size_t size = (size_t)w * h * numComponents;
+		chain.levels.push_back({ .width = w, .height = h, .offset = totalSize, .size = size });
+		totalSize += size;
+	}
+	chain.data.resize(totalSize);
+
+	// The first level is the image itself, the rest are filtered from the previous level in linear space
+	std::copy(pixels, pixels + chain.levels[0].size, chain.data.begin());
+	std::vector<float> current((size_t)width * height * kWorkComponents);
+	std::vector<float> next;
+	std::vector<float> scratch;
+	toLinear(pixels, (size_t)width * height, numComponents, isSRGB, current.data());
+
+	for (uint32_t level = 1; level < numLevels; ++level) {
+		const MipChain::Level &src = chain.levels[level - 1];
+		const MipChain::Level &dst = chain.levels[level];
+		next.resize((size_t)dst.width * dst.height * kWorkComponents);
+		if (filter == MipFilter::Kaiser) {
+			downsampleKaiser(current.data(), src.width, src.height, next.data(), dst.width, dst.height, scratch);
+		}
+		else {
+			downsampleBox(current.data(), src.width, src.height, next.data(), dst.width, dst.height);
+		}
+		fromLinear(next.data(), (size_t)dst.width * dst.height, numComponents, isSRGB, chain.data.data() + dst.offset);
+		current.swap(next);
+	}
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+enum class MipFilter {
+	// Averages each 2x2 block. The cheapest option
+	Box,
+	// Windowed sinc with 8 taps per axis. Keeps more detail and aliases less than the box filter
+	Kaiser
+};
+
+// Every level of a texture, from the full resolution one to 1x1, stored one after the other
+struct MipChain {
+	struct Level {
+		int width;
+		int height;
+		size_t offset;
+		size_t size;
+	};
+
+	int numComponents = 0;
+	std::vector<Level> levels;
+	std::vector<uint8_t> data;
+};
+
+uint32_t getNumMipLevels(int width, int height);
+
+// Builds the whole mip chain of an 8 bit image with 3 (RGB) or 4 (RGBA) components.
+// When isSRGB is true color is filtered in linear space, which keeps the average brightness of each level,
+// alpha is always linear. Filtering is vectorized with AVX2 when BUILD_WITH_AVX2 is enabled and with SSE2 otherwise
+void generateMipChain(const uint8_t *pixels, int width, int height, int numComponents, MipFilter filter, bool isSRGB, MipChain &chain);
@@ -0,0 +1,29 @@
+#include "shared/ProfilerCapture.h"
+
+#include "shared/EasyProfilerWrapper.h"
+#include <stdio.h>
+#include <algorithm>
+
+ProfilerCapture::ProfilerCapture(const CommandLine &commandLine)
+	: numFrames_((uint32_t)std::max<int64_t>(0, commandLine.getInt("profile-frames", 0)))
+	, output_(commandLine.getString("profile-output", "capture.prof")) {
+	if (!isEnabled()) {
+		return;
+	}
+#if BUILD_WITH_EASY_PROFILER
+	EASY_PROFILER_ENABLE;
+#else
+	fprintf(stderr, "Built without BUILD_WITH_EASY_PROFILER, --profile-frames only stops the run after %u frames\n", numFrames_);
+#endif
+}
+
+void ProfilerCapture::endFrame() {
+	if (!isEnabled() || finished_ || ++frame_ < numFrames_) {
+		return;
+	}
+	finished_ = true;
+#if BUILD_WITH_EASY_PROFILER
+	const uint32_t numBlocks = profiler::dumpBlocksToFile(output_.c_str());
+	printf("Profiled %u frames, %u blocks written to %s\n", numFrames_, numBlocks, output_.c_str());
+#endif
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "shared/CommandLine.h"
+#include <stdint.h>
+#include <string>
+
+// Records the first frames of a run with Easy Profiler and writes them to a .prof file the Easy Profiler GUI opens.
+// It's driven by the command line so it works the same in headless runs:
+//
+//   --profile-frames N [--profile-output <file.prof>]
+//
+// Create it before anything else in main so the startup, window setup, shader compiles and asset loads
+// included, is part of the capture. Examples close themselves once isFinished() returns true.
+class ProfilerCapture {
+public:
+	explicit ProfilerCapture(const CommandLine &commandLine);
+
+	bool isEnabled() const { return numFrames_ > 0; }
+	// Call it at the end of every frame, the capture is written after the last one
+	void endFrame();
+	bool isFinished() const { return finished_; }
+
+private:
+	uint32_t numFrames_ = 0;
+	uint32_t frame_ = 0;
+	std::string output_;
+	bool finished_ = false;
+};
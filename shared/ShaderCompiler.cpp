@@ -0,0 +1,111 @@
+#include "shared/ShaderCompiler.h"
+
+#include "shared/MappedFile.h"
+#include <glslang/Public/ShaderLang.h>
+#include <SPIRV/GlslangToSpv.h>
+#include <StandAlone/ResourceLimits.h>
+
+#include <filesystem>
+#include <mutex>
+
+static bool getShaderLanguage(const char *fileName, EShLanguage &language) {
+	const std::string extension = std::filesystem::path(fileName).extension().string();
+	if (extension == ".vert") {
+		language = EShLangVertex;
+	}
+	else if (extension == ".tesc") {
+		language = EShLangTessControl;
+	}
+	else if (extension == ".tese") {
+		language = EShLangTessEvaluation;
+	}
+	else if (extension == ".geom") {
+		language = EShLangGeometry;
+	}
+	else if (extension == ".frag") {
+		language = EShLangFragment;
+	}
+	else if (extension == ".comp") {
+		language = EShLangCompute;
+	}
+	else {
+		return false;
+	}
+	return true;
+}
+
+bool isShaderFile(const char *fileName) {
+	EShLanguage language;
+	return getShaderLanguage(fileName, language);
+}
+
+bool readShaderFile(const char *fileName, std::string &source) {
+	MappedFile file(fileName);
+	if (!file.isValid()) {
+		return false;
+	}
+	source.assign((const char*)file.getData(), file.getSize());
+	return true;
+}
+
+std::string getShaderSPIRVPath(const char *fileName) {
+	return std::string(fileName) + ".spv";
+}
+
+bool isShaderSPIRVUpToDate(const char *fileName) {
+	std::error_code error;
+	const auto sourceTime = std::filesystem::last_write_time(fileName, error);
+	if (error) {
+		return false;
+	}
+	const auto spirvTime = std::filesystem::last_write_time(getShaderSPIRVPath(fileName), error);
+	return !error && spirvTime >= sourceTime;
+}
+
+bool compileShaderToSPIRV(const char *fileName, std::vector<uint32_t> &spirv, std::string &log) {
+	// glslang keeps global tables that have to be set up once before any thread compiles
+	static std::once_flag initialized;
+	std::call_once(initialized, []() { glslang::InitializeProcess(); });
+
+	EShLanguage language;
+	if (!getShaderLanguage(fileName, language)) {
+		log = std::string(fileName) + ": unknown shader stage\n";
+		return false;
+	}
+	std::string source;
+	if (!readShaderFile(fileName, source)) {
+		log = std::string(fileName) + ": can't read the file\n";
+		return false;
+	}
+
+	// The same environment glslangValidator -G uses, SPIR-V for GL_ARB_gl_spirv
+	glslang::TShader shader(language);
+	const char *text = source.c_str();
+	const int length = (int)source.size();
+	shader.setStringsWithLengthsAndNames(&text, &length, &fileName, 1);
+	shader.setEnvInput(glslang::EShSourceGlsl, language, glslang::EShClientOpenGL, 100);
+	shader.setEnvClient(glslang::EShClientOpenGL, glslang::EShTargetOpenGL_450);
+	shader.setEnvTarget(glslang::EShTargetSpv, glslang::EShTargetSpv_1_0);
+	const EShMessages messages = (EShMessages)(EShMsgSpvRules | EShMsgDefault);
+
+	const bool parsed = shader.parse(&glslang::DefaultTBuiltInResource, 460, false, messages);
+	log = shader.getInfoLog();
+	if (!parsed) {
+		return false;
+	}
+
+	glslang::TProgram program;
+	program.addShader(&shader);
+	const bool linked = program.link(messages);
+	log += program.getInfoLog();
+	if (!linked) {
+		return false;
+	}
+
+	spv::SpvBuildLogger logger;
+	glslang::SpvOptions options;
+	spirv.clear();
+	glslang::GlslangToSpv(*program.getIntermediate(language), spirv, &logger, &options);
+	log += logger.getAllMessages();
+	return !spirv.empty();
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// GLSL shaders live in their own files and the stage comes from the extension:
+// .vert, .tesc, .tese, .geom, .frag or .comp.
+// The ShaderCompiler tool compiles them to SPIR-V at build time, writing <file>.spv next to every source,
+// and GLShader loads that instead of compiling the GLSL at runtime.
+
+bool isShaderFile(const char *fileName);
+bool readShaderFile(const char *fileName, std::string &source);
+
+std::string getShaderSPIRVPath(const char *fileName);
+// False when the SPIR-V file is missing or older than its source, in which case the GLSL has to be compiled
+bool isShaderSPIRVUpToDate(const char *fileName);
+
+// Compiles a shader file to SPIR-V for OpenGL 4.6 with glslang. The errors and warnings go to log, prefixed
+// with the file name and line. Safe to call from several threads at the same time
+bool compileShaderToSPIRV(const char *fileName, std::vector<uint32_t> &spirv, std::string &log);
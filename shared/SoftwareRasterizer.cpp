@@ -0,0 +1,341 @@
+#include "shared/SoftwareRasterizer.h"
+
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+#include <thread>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define RASTER_AVX2 1
+static const int kLanes = 8;
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define RASTER_SSE2 1
+static const int kLanes = 4;
+#else
+static const int kLanes = 1;
+#endif
+
+// Small enough that a tile of color and depth stays in L2, big enough that few triangles land in many tiles
+static const int kTileSize = 64;
+// A triangle clipped by the near and far planes has 5 vertices at most
+static const int kMaxClipVertices = 8;
+
+namespace {
+
+enum class ClipPlane { Near, Far };
+
+}
+
+// Tests kLanes pixels of a row, starting at x, against the triangle and the depth buffer. Returns a bit per pixel that
+// is covered and closer than what depth holds, whose depth is then replaced, and writes every pixel's l1 and l2
+#if RASTER_AVX2
+
+static uint32_t testSpan(const float *a, const float *b, const float *c, const bool *inclusive, float invArea, const float *z,
+	int x, float py, float *depth, float *l1, float *l2) {
+	const __m256 px = _mm256_add_ps(_mm256_set1_ps(x + 0.5f), _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f));
+	const __m256 zero = _mm256_setzero_ps();
+	__m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+	__m256 w[3];
+	for (int i = 0; i < 3; ++i) {
+		const __m256 e = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(a[i]), px), _mm256_set1_ps(b[i] * py + c[i]));
+		w[i] = _mm256_mul_ps(e, _mm256_set1_ps(invArea));
+		inside = _mm256_and_ps(inside, inclusive[i] ? _mm256_cmp_ps(w[i], zero, _CMP_GE_OQ) : _mm256_cmp_ps(w[i], zero, _CMP_GT_OQ));
+	}
+	const __m256 fragmentZ = _mm256_add_ps(_mm256_set1_ps(z[0]), _mm256_add_ps(
+		_mm256_mul_ps(_mm256_set1_ps(z[1] - z[0]), w[1]),
+		_mm256_mul_ps(_mm256_set1_ps(z[2] - z[0]), w[2])));
+	const __m256 bufferZ = _mm256_loadu_ps(depth);
+	const __m256 pass = _mm256_and_ps(inside, _mm256_cmp_ps(fragmentZ, bufferZ, _CMP_LT_OQ));
+	_mm256_storeu_ps(depth, _mm256_blendv_ps(bufferZ, fragmentZ, pass));
+	_mm256_storeu_ps(l1, w[1]);
+	_mm256_storeu_ps(l2, w[2]);
+	return (uint32_t)_mm256_movemask_ps(pass);
+}
+
+#elif RASTER_SSE2
+
+static uint32_t testSpan(const float *a, const float *b, const float *c, const bool *inclusive, float invArea, const float *z,
+	int x, float py, float *depth, float *l1, float *l2) {
+	const __m128 px = _mm_add_ps(_mm_set1_ps(x + 0.5f), _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f));
+	const __m128 zero = _mm_setzero_ps();
+	__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+	__m128 w[3];
+	for (int i = 0; i < 3; ++i) {
+		const __m128 e = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(a[i]), px), _mm_set1_ps(b[i] * py + c[i]));
+		w[i] = _mm_mul_ps(e, _mm_set1_ps(invArea));
+		inside = _mm_and_ps(inside, inclusive[i] ? _mm_cmpge_ps(w[i], zero) : _mm_cmpgt_ps(w[i], zero));
+	}
+	const __m128 fragmentZ = _mm_add_ps(_mm_set1_ps(z[0]), _mm_add_ps(
+		_mm_mul_ps(_mm_set1_ps(z[1] - z[0]), w[1]),
+		_mm_mul_ps(_mm_set1_ps(z[2] - z[0]), w[2])));
+	const __m128 bufferZ = _mm_loadu_ps(depth);
+	const __m128 pass = _mm_and_ps(inside, _mm_cmplt_ps(fragmentZ, bufferZ));
+	// SSE2 has no blend, the mask selects between both values instead
+	_mm_storeu_ps(depth, _mm_or_ps(_mm_and_ps(pass, fragmentZ), _mm_andnot_ps(pass, bufferZ)));
+	_mm_storeu_ps(l1, w[1]);
+	_mm_storeu_ps(l2, w[2]);
+	return (uint32_t)_mm_movemask_ps(pass);
+}
+
+#else
+
+static uint32_t testSpan(const float *a, const float *b, const float *c, const bool *inclusive, float invArea, const float *z,
+	int x, float py, float *depth, float *l1, float *l2) {
+	const float px = x + 0.5f;
+	float w[3];
+	for (int i = 0; i < 3; ++i) {
+		w[i] = (a[i] * px + (b[i] * py + c[i])) * invArea;
+		if (inclusive[i] ? w[i] < 0.0f : w[i] <= 0.0f) {
+			return 0;
+		}
+	}
+	const float fragmentZ = z[0] + ((z[1] - z[0]) * w[1] + (z[2] - z[0]) * w[2]);
+	if (!(fragmentZ < depth[0])) {
+		return 0;
+	}
+	depth[0] = fragmentZ;
+	l1[0] = w[1];
+	l2[0] = w[2];
+	return 1;
+}
+
+#endif
+
+// Positive on the inner side of plane. In clip space, so it works for vertices behind the camera too
+static float getPlaneDistance(const glm::vec4 &position, ClipPlane plane) {
+	return plane == ClipPlane::Near ? position.z + position.w : position.w - position.z;
+}
+
+// GL_LINEAR with GL_REPEAT on the first level
+static glm::vec4 sampleTexture(const SoftwareRasterizer::Texture &texture, const glm::vec2 &uv) {
+	const float x = uv.x * texture.width - 0.5f;
+	const float y = uv.y * texture.height - 0.5f;
+	const float fx = floorf(x);
+	const float fy = floorf(y);
+	auto texel = [&texture](int i, int j) {
+		i = (i % texture.width + texture.width) % texture.width;
+		j = (j % texture.height + texture.height) % texture.height;
+		const uint8_t *p = &texture.pixels[((size_t)j * texture.width + i) * 4];
+		return glm::vec4(p[0], p[1], p[2], p[3]) * (1.0f / 255.0f);
+	};
+	const int i = (int)fx;
+	const int j = (int)fy;
+	const glm::vec4 top = glm::mix(texel(i, j), texel(i + 1, j), x - fx);
+	const glm::vec4 bottom = glm::mix(texel(i, j + 1), texel(i + 1, j + 1), x - fx);
+	return glm::mix(top, bottom, y - fy);
+}
+
+SoftwareRasterizer::SoftwareRasterizer(int width, int height, unsigned int numThreads)
+	: width_(width)
+	, height_(height)
+	, tilesX_((width + kTileSize - 1) / kTileSize)
+	, tilesY_((height + kTileSize - 1) / kTileSize)
+	, executor_(numThreads > 0 ? numThreads : std::max(1u, std::thread::hardware_concurrency())) {
+	stride_ = tilesX_ * kTileSize;
+	const size_t numPixels = (size_t)stride_ * tilesY_ * kTileSize;
+	color_.resize(numPixels * 4);
+	depth_.resize(numPixels);
+	tileTriangles_.resize((size_t)tilesX_ * tilesY_);
+}
+
+void SoftwareRasterizer::clear(const glm::vec4 &color, float depth) {
+	const glm::vec4 clamped = glm::clamp(color, glm::vec4(0.0f), glm::vec4(1.0f)) * 255.0f + 0.5f;
+	const uint8_t rgba[4] = { (uint8_t)clamped.x, (uint8_t)clamped.y, (uint8_t)clamped.z, (uint8_t)clamped.w };
+	for (size_t i = 0; i < color_.size(); i += 4) {
+		memcpy(&color_[i], rgba, 4);
+	}
+	std::fill(depth_.begin(), depth_.end(), depth);
+}
+
+void SoftwareRasterizer::drawTriangles(const DrawState &state, const Vertex *vertices, uint32_t numVertices) {
+	triangles_.clear();
+	for (std::vector<uint32_t> &triangles : tileTriangles_) {
+		triangles.clear();
+	}
+
+	for (uint32_t first = 0; first + 2 < numVertices; first += 3) {
+		ClipVertex polygon[kMaxClipVertices];
+		ClipVertex clipped[kMaxClipVertices];
+		for (int i = 0; i < 3; ++i) {
+			const Vertex &vertex = vertices[first + i];
+			polygon[i] = {
+				.position = state.mvp * glm::vec4(vertex.position, 1.0f),
+				.color = vertex.color,
+				.uv = vertex.uv,
+				.barycentrics = glm::vec3(i == 0, i == 1, i == 2)
+			};
+		}
+
+		// Sutherland-Hodgman against the near plane and then the far one, most triangles are inside both
+		int count = 3;
+		for (ClipPlane plane : { ClipPlane::Near, ClipPlane::Far }) {
+			int clippedCount = 0;
+			for (int i = 0; i < count; ++i) {
+				const ClipVertex &a = polygon[i];
+				const ClipVertex &b = polygon[(i + 1) % count];
+				const float da = getPlaneDistance(a.position, plane);
+				const float db = getPlaneDistance(b.position, plane);
+				if (da >= 0.0f) {
+					clipped[clippedCount++] = a;
+				}
+				if ((da >= 0.0f) != (db >= 0.0f)) {
+					const float t = da / (da - db);
+					clipped[clippedCount++] = {
+						.position = glm::mix(a.position, b.position, t),
+						.color = glm::mix(a.color, b.color, t),
+						.uv = glm::mix(a.uv, b.uv, t),
+						.barycentrics = glm::mix(a.barycentrics, b.barycentrics, t)
+					};
+				}
+			}
+			std::copy(clipped, clipped + clippedCount, polygon);
+			count = clippedCount;
+		}
+
+		for (int i = 1; i + 1 < count; ++i) {
+			setupTriangle(polygon[0], polygon[i], polygon[i + 1]);
+		}
+	}
+	if (triangles_.empty()) {
+		return;
+	}
+
+	tf::Taskflow taskflow;
+	taskflow.for_each_index(0, tilesX_ * tilesY_, 1, [this, &state](int tile) {
+		rasterizeTile(state, (uint32_t)tile);
+	});
+	executor_.run(taskflow).wait();
+}
+
+void SoftwareRasterizer::getPixels(std::vector<uint8_t> &pixels) const {
+	pixels.resize((size_t)width_ * height_ * 4);
+	for (int y = 0; y < height_; ++y) {
+		memcpy(&pixels[(size_t)y * width_ * 4], &color_[(size_t)y * stride_ * 4], (size_t)width_ * 4);
+	}
+}
+
+void SoftwareRasterizer::setupTriangle(const ClipVertex &v0, const ClipVertex &v1, const ClipVertex &v2) {
+	const ClipVertex *vertices[3] = { &v0, &v1, &v2 };
+	Triangle triangle;
+	glm::vec2 window[3];
+	for (int i = 0; i < 3; ++i) {
+		// Clipping left w > 0, the viewport transform is the one glViewport(0, 0, width, height) sets up
+		const glm::vec4 &position = vertices[i]->position;
+		triangle.invW[i] = 1.0f / position.w;
+		window[i] = glm::vec2(
+			(position.x * triangle.invW[i] * 0.5f + 0.5f) * width_,
+			(position.y * triangle.invW[i] * 0.5f + 0.5f) * height_);
+		triangle.z[i] = position.z * triangle.invW[i] * 0.5f + 0.5f;
+		triangle.color[i] = vertices[i]->color;
+		triangle.uv[i] = vertices[i]->uv;
+		triangle.barycentrics[i] = vertices[i]->barycentrics;
+	}
+
+	for (int i = 0; i < 3; ++i) {
+		const glm::vec2 &p = window[(i + 1) % 3];
+		const glm::vec2 &q = window[(i + 2) % 3];
+		triangle.a[i] = p.y - q.y;
+		triangle.b[i] = q.x - p.x;
+		triangle.c[i] = p.x * q.y - q.x * p.y;
+	}
+	// Twice the signed area, negative for clockwise triangles, which flips the sign of every edge function
+	const float area = triangle.a[0] * window[0].x + (triangle.b[0] * window[0].y + triangle.c[0]);
+	if (!(fabsf(area) > 0.0f) || !isfinite(area)) {
+		return;
+	}
+	triangle.invArea = 1.0f / area;
+	for (int i = 0; i < 3; ++i) {
+		// With the gradient pointing inside, left edges have it pointing right and top edges have it pointing down.
+		// A shared edge is left or top for exactly one of its two triangles
+		const float a = area > 0.0f ? triangle.a[i] : -triangle.a[i];
+		const float b = area > 0.0f ? triangle.b[i] : -triangle.b[i];
+		triangle.inclusive[i] = a > 0.0f || (a == 0.0f && b < 0.0f);
+	}
+
+	const glm::vec2 minBounds = glm::min(window[0], glm::min(window[1], window[2]));
+	const glm::vec2 maxBounds = glm::max(window[0], glm::max(window[1], window[2]));
+	triangle.minX = std::max(0, (int)floorf(minBounds.x));
+	triangle.minY = std::max(0, (int)floorf(minBounds.y));
+	triangle.maxX = std::min(width_ - 1, (int)ceilf(maxBounds.x));
+	triangle.maxY = std::min(height_ - 1, (int)ceilf(maxBounds.y));
+	if (triangle.minX > triangle.maxX || triangle.minY > triangle.maxY) {
+		return;
+	}
+
+	const uint32_t index = (uint32_t)triangles_.size();
+	triangles_.push_back(triangle);
+	for (int tileY = triangle.minY / kTileSize; tileY <= triangle.maxY / kTileSize; ++tileY) {
+		for (int tileX = triangle.minX / kTileSize; tileX <= triangle.maxX / kTileSize; ++tileX) {
+			tileTriangles_[tileY * tilesX_ + tileX].push_back(index);
+		}
+	}
+}
+
+void SoftwareRasterizer::rasterizeTile(const DrawState &state, uint32_t tile) {
+	const int tileX = (int)(tile % tilesX_) * kTileSize;
+	const int tileY = (int)(tile / tilesX_) * kTileSize;
+	float l1[kLanes];
+	float l2[kLanes];
+	for (uint32_t index : tileTriangles_[tile]) {
+		const Triangle &triangle = triangles_[index];
+		// Tiles are a multiple of kLanes wide, so aligned spans never cross into the next tile. Pixels outside
+		// the bounds of the triangle are outside the triangle too, spans can start before them safely
+		const int minX = std::max(triangle.minX, tileX) / kLanes * kLanes;
+		const int maxX = std::min(triangle.maxX, tileX + kTileSize - 1);
+		const int minY = std::max(triangle.minY, tileY);
+		const int maxY = std::min(triangle.maxY, tileY + kTileSize - 1);
+		for (int y = minY; y <= maxY; ++y) {
+			float *depthRow = &depth_[(size_t)y * stride_];
+			const float py = y + 0.5f;
+			for (int x = minX; x <= maxX; x += kLanes) {
+				const uint32_t mask = testSpan(triangle.a, triangle.b, triangle.c, triangle.inclusive, triangle.invArea, triangle.z,
+					x, py, depthRow + x, l1, l2);
+				for (int lane = 0; mask != 0 && lane < kLanes; ++lane) {
+					if (mask & (1u << lane)) {
+						shadePixel(state, triangle, x + lane, y, l1[lane], l2[lane]);
+					}
+				}
+			}
+		}
+	}
+}
+
+void SoftwareRasterizer::shadePixel(const DrawState &state, const Triangle &triangle, int x, int y, float l1, float l2) {
+	// Screen space barycentrics weighted by 1/w, what GL does for every smooth varying
+	auto getPerspectiveBarycentrics = [&triangle](float l1, float l2) {
+		const glm::vec3 weighted = glm::vec3(1.0f - l1 - l2, l1, l2) * glm::vec3(triangle.invW[0], triangle.invW[1], triangle.invW[2]);
+		return weighted / (weighted.x + weighted.y + weighted.z);
+	};
+	const glm::vec3 barycentrics = getPerspectiveBarycentrics(l1, l2);
+
+	glm::vec4 color(triangle.color[0] * barycentrics.x + triangle.color[1] * barycentrics.y + triangle.color[2] * barycentrics.z, 1.0f);
+	if (state.texture) {
+		const glm::vec2 uv = triangle.uv[0] * barycentrics.x + triangle.uv[1] * barycentrics.y + triangle.uv[2] * barycentrics.z;
+		color *= sampleTexture(*state.texture, uv);
+	}
+
+	if (state.wireframe) {
+		// The edgeFactor() of the example shaders, with fwidth computed from the neighbours to the right and above.
+		// The edges are those of the triangle before clipping, its barycentrics are interpolated like a varying
+		auto getTriangleBarycentrics = [&triangle](const glm::vec3 &weights) {
+			return triangle.barycentrics[0] * weights.x + triangle.barycentrics[1] * weights.y + triangle.barycentrics[2] * weights.z;
+		};
+		const float dx = triangle.invArea;
+		const glm::vec3 center = getTriangleBarycentrics(barycentrics);
+		const glm::vec3 right = getTriangleBarycentrics(getPerspectiveBarycentrics(l1 + triangle.a[1] * dx, l2 + triangle.a[2] * dx));
+		const glm::vec3 up = getTriangleBarycentrics(getPerspectiveBarycentrics(l1 + triangle.b[1] * dx, l2 + triangle.b[2] * dx));
+		const glm::vec3 width = glm::max(glm::abs(right - center) + glm::abs(up - center), glm::vec3(1e-6f));
+		const glm::vec3 edges = glm::smoothstep(glm::vec3(0.0f), width, center);
+		const float edge = std::min(edges.x, std::min(edges.y, edges.z));
+		color = glm::vec4(glm::mix(glm::vec3(1.0f), glm::vec3(color), edge), color.w);
+	}
+
+	const glm::vec4 clamped = glm::clamp(color, glm::vec4(0.0f), glm::vec4(1.0f)) * 255.0f + 0.5f;
+	uint8_t *pixel = &color_[((size_t)y * stride_ + x) * 4];
+	pixel[0] = (uint8_t)clamped.x;
+	pixel[1] = (uint8_t)clamped.y;
+	pixel[2] = (uint8_t)clamped.z;
+	pixel[3] = (uint8_t)clamped.w;
+}
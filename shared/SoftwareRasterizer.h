@@ -0,0 +1,99 @@
+#pragma once
+
+#include "taskflow/taskflow.hpp"
+#include <glm/glm.hpp>
+#include <stdint.h>
+#include <vector>
+
+// Draws triangles on the CPU the way the examples draw them with OpenGL, for machines without a GPU and as a
+// baseline for the transform and raster cost. It follows the GL conventions the examples rely on, so its images
+// can be compared with GL captures of the same frame:
+//  * clip space as glm produces it, clipped to the near and far planes, with depth mapped to [0, 1] and GL_LESS
+//  * pixel centers at half integers, a top-left fill rule and no face culling
+//  * row 0 is the bottom of the image, like glReadPixels and the PNGs GLFrameCapture writes
+// Triangles are transformed, clipped and binned into tiles on the calling thread, then every tile is rasterized by
+// a single worker so none of them needs a lock. Edge functions and the depth test are evaluated 8 pixels at a time
+// with AVX2 (BUILD_WITH_AVX2) and 4 with SSE2, shading is done per covered pixel.
+class SoftwareRasterizer {
+public:
+	struct Vertex {
+		glm::vec3 position;
+		glm::vec3 color;
+		glm::vec2 uv;
+	};
+
+	// RGBA8 rows from the top of the image down, as stb_image loads them and GLTextureLoader uploads them
+	struct Texture {
+		int width = 0;
+		int height = 0;
+		std::vector<uint8_t> pixels;
+	};
+
+	struct DrawState {
+		glm::mat4 mvp = glm::mat4(1.0f);
+		// Multiplies the vertex color when set. Sampled like GL_LINEAR with GL_REPEAT, without mipmaps
+		const Texture *texture = nullptr;
+		// Blends white lines over the triangle edges, what the single-pass wireframe of the examples does
+		bool wireframe = false;
+	};
+
+	// numThreads 0 uses every core
+	SoftwareRasterizer(int width, int height, unsigned int numThreads = 0);
+
+	SoftwareRasterizer(const SoftwareRasterizer&) = delete;
+	SoftwareRasterizer& operator=(const SoftwareRasterizer&) = delete;
+
+	void clear(const glm::vec4 &color, float depth = 1.0f);
+	// A list of 3 vertices per triangle, like glDrawArrays(GL_TRIANGLES). Returns once every pixel is written
+	void drawTriangles(const DrawState &state, const Vertex *vertices, uint32_t numVertices);
+
+	int getWidth() const { return width_; }
+	int getHeight() const { return height_; }
+	// The color buffer as tightly packed RGBA8 rows, bottom row first
+	void getPixels(std::vector<uint8_t> &pixels) const;
+
+private:
+	// A triangle in window coordinates. Edge function i is 0 on the edge opposite vertex i and divided by
+	// the area it gives the barycentric coordinate of that vertex
+	struct Triangle {
+		float a[3];
+		float b[3];
+		float c[3];
+		float invArea;
+		// Pixel centers exactly on edge i belong to this triangle
+		bool inclusive[3];
+		float z[3];
+		// 1/w of every vertex, to interpolate the attributes with perspective correction
+		float invW[3];
+		glm::vec3 color[3];
+		glm::vec2 uv[3];
+		// Of every vertex in the triangle it was clipped from, so clipping adds no edges to the wireframe
+		glm::vec3 barycentrics[3];
+		int minX, minY, maxX, maxY;
+	};
+
+	struct ClipVertex {
+		glm::vec4 position;
+		glm::vec3 color;
+		glm::vec2 uv;
+		glm::vec3 barycentrics;
+	};
+
+	void setupTriangle(const ClipVertex &v0, const ClipVertex &v1, const ClipVertex &v2);
+	void rasterizeTile(const DrawState &state, uint32_t tile);
+	void shadePixel(const DrawState &state, const Triangle &triangle, int x, int y, float l1, float l2);
+
+	int width_;
+	int height_;
+	// Rows are padded to whole tiles so spans of pixels never need bounds checks
+	int stride_;
+	int tilesX_;
+	int tilesY_;
+	std::vector<uint8_t> color_;
+	std::vector<float> depth_;
+
+	std::vector<Triangle> triangles_;
+	// The triangles that overlap each tile, in the order they were drawn
+	std::vector<std::vector<uint32_t>> tileTriangles_;
+	tf::Executor executor_;
+};
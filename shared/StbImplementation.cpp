@@ -0,0 +1,5 @@
+// The STB libraries are header-only, their implementation has to be compiled in exactly one translation unit
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include "stb/stb_image_write.h"
@@ -0,0 +1,286 @@
+#include "shared/TextureCache.h"
+
+#include <glad/gl.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <filesystem>
+#include <functional>
+#include <thread>
+
+// Bump it whenever the file layout or the way textures are processed changes
+static const uint32_t kCacheVersion = 1;
+static const uint32_t kCacheMagic = 0x58544743; // "CGTX"
+static const uint64_t kDataAlignment = 16;
+// A 2^31 texel wide texture has 32 levels, entries claiming more are corrupt
+static const uint32_t kMaxLevels = 32;
+
+namespace {
+
+struct CacheHeader {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t internalFormat;
+	uint32_t isCompressed;
+	uint32_t numLevels;
+	uint32_t padding;
+	uint64_t dataOffset;
+	uint64_t dataSize;
+};
+
+struct CacheLevel {
+	uint32_t width;
+	uint32_t height;
+	uint64_t offset;
+	uint64_t size;
+};
+
+// The bytes a level of width x height texels takes in the formats GLTextureLoader stores, 0 for any other format.
+// Rows are tightly packed, the loader uploads with GL_UNPACK_ALIGNMENT 1
+uint64_t getLevelSize(uint32_t internalFormat, bool isCompressed, uint64_t width, uint64_t height) {
+	if (internalFormat == GL_RGB8 && !isCompressed) {
+		return width * height * 3;
+	}
+	// 8 bytes per block of 4x4 texels
+	if (internalFormat == GL_COMPRESSED_RGB8_ETC2 && isCompressed) {
+		return (width + 3) / 4 * ((height + 3) / 4) * 8;
+	}
+	return 0;
+}
+
+}
+
+TextureCache::TextureCache(const std::string &directory)
+	: directory_(directory) {
+	if (isEnabled()) {
+		std::error_code error;
+		std::filesystem::create_directories(directory_, error);
+	}
+}
+
+bool TextureCache::load(uint64_t key, Entry &entry) const {
+	if (!isEnabled()) {
+		return false;
+	}
+
+	auto file = std::make_unique<MappedFile>(getPath(key));
+	if (!file->isValid() || file->getSize() < sizeof(CacheHeader)) {
+		return false;
+	}
+
+	// A truncated or corrupted entry is rejected like a missing one, the loader decodes the source image again
+	// and overwrites it. Sizes are compared by subtracting so huge values can't wrap around
+	const CacheHeader *header = (const CacheHeader*)file->getData();
+	const uint64_t fileSize = file->getSize();
+	if (header->magic != kCacheMagic || header->version != kCacheVersion ||
+		header->numLevels == 0 || header->numLevels > kMaxLevels) {
+		return false;
+	}
+	const uint64_t levelsEnd = sizeof(CacheHeader) + (uint64_t)header->numLevels * sizeof(CacheLevel);
+	if (levelsEnd > header->dataOffset || header->dataOffset > fileSize || header->dataSize > fileSize - header->dataOffset) {
+		return false;
+	}
+	// Every level must be big enough for its dimensions, GL reads width x height texels from it. Dimensions fit
+	// in an int, so the expected size can't overflow
+	const CacheLevel *levels = (const CacheLevel*)(header + 1);
+	for (uint32_t i = 0; i < header->numLevels; ++i) {
+		const CacheLevel &level = levels[i];
+		if (level.offset > header->dataSize || level.size > header->dataSize - level.offset ||
+			level.width == 0 || level.height == 0 || level.width > INT32_MAX || level.height > INT32_MAX) {
+			return false;
+		}
+		const uint64_t expectedSize = getLevelSize(header->internalFormat, header->isCompressed != 0, level.width, level.height);
+		if (expectedSize == 0 || level.size < expectedSize) {
+			return false;
+		}
+	}
+
+	// Everything points into the mapping, nothing is read from disk until the pixels are copied
+	entry.internalFormat = header->internalFormat;
+	entry.isCompressed = header->isCompressed != 0;
+	entry.levels.clear();
+	for (uint32_t i = 0; i < header->numLevels; ++i) {
+		entry.levels.push_back({ .width = (int)levels[i].width, .height = (int)levels[i].height,
+			.offset = (size_t)levels[i].offset, .size = (size_t)levels[i].size });
+	}
+	entry.pixels = file->getData() + header->dataOffset;
+	entry.file = std::move(file);
+	return true;
+}
+
+void TextureCache::store(uint64_t key, uint32_t internalFormat, bool isCompressed, const MipChain &mipChain) const {
+	if (!isEnabled()) {
+		return;
+	}
+
+	const uint64_t levelsEnd = sizeof(CacheHeader) + mipChain.levels.size() * sizeof(CacheLevel);
+	CacheHeader header = {
+		.magic = kCacheMagic,
+		.version = kCacheVersion,
+		.internalFormat = internalFormat,
+		.isCompressed = isCompressed ? 1u : 0u,
+		.numLevels = (uint32_t)mipChain.levels.size(),
+		.padding = 0,
+		.dataOffset = (levelsEnd + kDataAlignment - 1) / kDataAlignment * kDataAlignment,
+		.dataSize = mipChain.data.size()
+	};
+
+	const std::string path = getPath(key);
+	const std::string temporaryPath = path + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()));
+	FILE *file = fopen(temporaryPath.c_str(), "wb");
+	if (!file) {
+		fprintf(stderr, "Can't write texture cache entry %s\n", temporaryPath.c_str());
+		return;
+	}
+
+	fwrite(&header, sizeof(header), 1, file);
+	for (const MipChain::Level &level : mipChain.levels) {
+		const CacheLevel cacheLevel = { .width = (uint32_t)level.width, .height = (uint32_t)level.height, .offset = level.offset, .size = level.size };
+		fwrite(&cacheLevel, sizeof(cacheLevel), 1, file);
+	}
+	const uint8_t padding[kDataAlignment] = {};
+	fwrite(padding, 1, (size_t)(header.dataOffset - levelsEnd), file);
+	const bool written = fwrite(mipChain.data.data(), 1, mipChain.data.size(), file) == mipChain.data.size();
+	fclose(file);
+
+	std::error_code error;
+	if (written) {
+		std::filesystem::rename(temporaryPath, path, error);
+	}
+	if (!written || error) {
+		std::filesystem::remove(temporaryPath, error);
+	}
+}
+
+std::string TextureCache::getPath(uint64_t key) const {
+	char name[24];
+	snprintf(name, sizeof(name), "%016llx.tex", (unsigned long long)key);
+	return (std::filesystem::path(directory_) / name).string();
+}
+
+// Reads and writes whole entries for selfTest
+static bool readFile(const std::string &path, std::vector<uint8_t> &bytes) {
+	FILE *file = fopen(path.c_str(), "rb");
+	if (!file) {
+		return false;
+	}
+	fseek(file, 0, SEEK_END);
+	bytes.resize((size_t)ftell(file));
+	fseek(file, 0, SEEK_SET);
+	const bool read = fread(bytes.data(), 1, bytes.size(), file) == bytes.size();
+	fclose(file);
+	return read;
+}
+
+static bool writeFile(const std::string &path, const std::vector<uint8_t> &bytes) {
+	FILE *file = fopen(path.c_str(), "wb");
+	if (!file) {
+		return false;
+	}
+	const bool written = fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size();
+	fclose(file);
+	return written;
+}
+
+bool TextureCache::selfTest(const std::string &directory) {
+	std::error_code error;
+	std::filesystem::remove_all(directory, error);
+	const TextureCache cache(directory);
+	if (!cache.isEnabled()) {
+		return false;
+	}
+
+	// The two kinds of entries GLTextureLoader stores: a decoded image with its mip chain, and the levels of a baked
+	// ETC2 texture. Pixel values don't matter, only the layout is checked
+	std::vector<uint8_t> image(37 * 20 * 3);
+	for (size_t i = 0; i < image.size(); ++i) {
+		image[i] = (uint8_t)(i * 7);
+	}
+	MipChain decoded;
+	generateMipChain(image.data(), 37, 20, 3, MipFilter::Box, true, decoded);
+	MipChain compressed;
+	for (int width = 37, height = 20; ; width = std::max(1, width / 2), height = std::max(1, height / 2)) {
+		const size_t size = (size_t)getLevelSize(GL_COMPRESSED_RGB8_ETC2, true, width, height);
+		compressed.levels.push_back({ .width = width, .height = height, .offset = compressed.data.size(), .size = size });
+		compressed.data.resize(compressed.data.size() + size, (uint8_t)compressed.levels.size());
+		if (width == 1 && height == 1) {
+			break;
+		}
+	}
+
+	struct Source {
+		const char *name;
+		uint32_t internalFormat;
+		bool isCompressed;
+		const MipChain *mipChain;
+	};
+	const Source sources[] = {
+		{ "GL_RGB8", GL_RGB8, false, &decoded },
+		{ "GL_COMPRESSED_RGB8_ETC2", GL_COMPRESSED_RGB8_ETC2, true, &compressed }
+	};
+
+	// Each corruption edits a copy of a valid entry. header and levels point into the copy
+	using Corrupt = std::function<void(std::vector<uint8_t> &bytes, CacheHeader &header, CacheLevel *levels)>;
+	struct Corruption {
+		const char *name;
+		Corrupt corrupt;
+	};
+	const Corruption corruptions[] = {
+		{ "Truncated inside the header", [](std::vector<uint8_t> &bytes, CacheHeader&, CacheLevel*) { bytes.resize(sizeof(CacheHeader) / 2); } },
+		{ "Truncated inside the level table", [](std::vector<uint8_t> &bytes, CacheHeader&, CacheLevel*) { bytes.resize(sizeof(CacheHeader) + sizeof(CacheLevel) / 2); } },
+		{ "Truncated inside the pixels", [](std::vector<uint8_t> &bytes, CacheHeader &header, CacheLevel*) { bytes.erase(bytes.end() - (ptrdiff_t)(header.dataSize / 2), bytes.end()); } },
+		{ "No levels", [](std::vector<uint8_t>&, CacheHeader &header, CacheLevel*) { header.numLevels = 0; } },
+		{ "Too many levels", [](std::vector<uint8_t>&, CacheHeader &header, CacheLevel*) { header.numLevels = UINT32_MAX; } },
+		{ "Data size wrapping around", [](std::vector<uint8_t>&, CacheHeader &header, CacheLevel*) { header.dataSize = UINT64_MAX; } },
+		{ "Level past the data", [](std::vector<uint8_t>&, CacheHeader &header, CacheLevel *levels) { levels[0].offset = header.dataSize; } },
+		{ "Level offset wrapping around", [](std::vector<uint8_t>&, CacheHeader&, CacheLevel *levels) { levels[0].offset = UINT64_MAX; } },
+		{ "Level larger than its size", [](std::vector<uint8_t>&, CacheHeader&, CacheLevel *levels) { levels[0].width = 1 << 20; } },
+		{ "Level without texels", [](std::vector<uint8_t>&, CacheHeader&, CacheLevel *levels) { levels[0].height = 0; } },
+		{ "Unknown internal format", [](std::vector<uint8_t>&, CacheHeader &header, CacheLevel*) { header.internalFormat = GL_RGBA32F; } },
+		{ "Compression flag flipped", [](std::vector<uint8_t>&, CacheHeader &header, CacheLevel*) { header.isCompressed ^= 1; } }
+	};
+
+	int failed = 0;
+	uint64_t key = 0;
+	for (const Source &source : sources) {
+		const std::string path = cache.getPath(key);
+		cache.store(key, source.internalFormat, source.isCompressed, *source.mipChain);
+		std::vector<uint8_t> valid;
+		Entry entry;
+		if (!readFile(path, valid) || !cache.load(key, entry) || entry.levels.size() != source.mipChain->levels.size()) {
+			fprintf(stderr, "A %s entry can't be stored and loaded back\n", source.name);
+			return false;
+		}
+		entry = {};
+
+		for (const Corruption &corruption : corruptions) {
+			// The edits go through copies of the structs, the bytes of the file aren't necessarily aligned for them
+			std::vector<uint8_t> bytes = valid;
+			CacheHeader header;
+			memcpy(&header, bytes.data(), sizeof(header));
+			std::vector<CacheLevel> levels(header.numLevels);
+			memcpy(levels.data(), bytes.data() + sizeof(header), levels.size() * sizeof(CacheLevel));
+			corruption.corrupt(bytes, header, levels.data());
+			if (bytes.size() >= sizeof(header) + levels.size() * sizeof(CacheLevel)) {
+				memcpy(bytes.data(), &header, sizeof(header));
+				memcpy(bytes.data() + sizeof(header), levels.data(), levels.size() * sizeof(CacheLevel));
+			}
+
+			// A rejected entry is what makes GLTextureLoader process the source again and store it over the broken one
+			bool passed = writeFile(path, bytes) && !cache.load(key, entry);
+			entry = {};
+			if (passed) {
+				cache.store(key, source.internalFormat, source.isCompressed, *source.mipChain);
+				passed = cache.load(key, entry) && entry.levels.size() == source.mipChain->levels.size() &&
+					memcmp(entry.pixels, source.mipChain->data.data(), source.mipChain->data.size()) == 0;
+				entry = {};
+			}
+			printf("%-24s %-36s %s\n", source.name, corruption.name, passed ? "OK" : "FAILED");
+			failed += passed ? 0 : 1;
+		}
+		++key;
+	}
+
+	std::filesystem::remove_all(directory, error);
+	return failed == 0;
+}
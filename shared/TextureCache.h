@@ -0,0 +1,41 @@
+#pragma once
+
+#include "shared/MappedFile.h"
+#include "shared/Mipmaps.h"
+#include <stdint.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Content-addressed on-disk cache of processed textures (decoded, mipmapped or compressed).
+// Entries are named after a key the caller computes from the source file contents and the processing
+// options, so editing an image or changing how it's processed never returns stale data.
+// Entries are memory mapped when read so their pixels can be copied straight from the page cache.
+class TextureCache {
+public:
+	struct Entry {
+		uint32_t internalFormat = 0;
+		bool isCompressed = false;
+		// Offsets are relative to pixels
+		std::vector<MipChain::Level> levels;
+		const uint8_t *pixels = nullptr;
+		std::unique_ptr<MappedFile> file;
+	};
+
+	// An empty directory disables the cache
+	explicit TextureCache(const std::string &directory);
+
+	bool isEnabled() const { return !directory_.empty(); }
+	bool load(uint64_t key, Entry &entry) const;
+	// Safe to call from several threads, entries are written to a temporary file and renamed when complete
+	void store(uint64_t key, uint32_t internalFormat, bool isCompressed, const MipChain &mipChain) const;
+
+	// Stores entries in directory, then truncates and corrupts them in every way load has to catch. Each broken
+	// entry must be rejected and the entry stored over it must load again. Prints a line per case and deletes directory
+	static bool selfTest(const std::string &directory);
+
+private:
+	std::string getPath(uint64_t key) const;
+
+	std::string directory_;
+};
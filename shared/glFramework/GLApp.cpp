@@ -0,0 +1,160 @@
+#include "shared/glFramework/GLApp.h"
+
+#include "shared/EasyProfilerWrapper.h"
+#include "shared/glFramework/GLHeadlessContext.h"
+#include "shared/glFramework/GLShader.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+GLApp::GLApp(int majorVersion, int minorVersion, int profile, int width, int height, const char *title, Backend backend)
+	: startTime_(std::chrono::steady_clock::now()) {
+	EASY_MAIN_THREAD;
+	EASY_FUNCTION();
+
+	// GLFW needs a display to initialize, so the headless backend doesn't touch it at all
+	if (backend == Backend::Headless) {
+		headless_ = std::make_unique<GLHeadlessContext>(majorVersion, minorVersion, profile, width, height);
+		if (!headless_->isValid()) {
+			exit(EXIT_FAILURE);
+		}
+		enableParallelShaderCompile(GLHeadlessContext::getProcAddress);
+		return;
+	}
+
+	glfwSetErrorCallback(
+		[](int error, const char *description) {
+			fprintf(stderr, "Error: %s\n", description);
+		}
+	);
+
+	if (!glfwInit()) {
+		exit(EXIT_FAILURE);
+	}
+
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, majorVersion);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, minorVersion);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, profile);
+	window_ = glfwCreateWindow(width, height, title, nullptr, nullptr);
+	if (!window_) {
+		glfwTerminate();
+		exit(EXIT_FAILURE);
+	}
+
+	// We store the app in the window so the GLFW callbacks, which can't capture anything, can reach it
+	glfwSetWindowUserPointer(window_, this);
+	glfwSetKeyCallback(window_, &GLApp::onKey);
+
+	glfwMakeContextCurrent(window_);
+	gladLoadGL(glfwGetProcAddress);
+	enableParallelShaderCompile(glfwGetProcAddress);
+	glfwSwapInterval(1);
+}
+
+GLApp::~GLApp() {
+	if (window_) {
+		glfwDestroyWindow(window_);
+		glfwTerminate();
+	}
+}
+
+void GLApp::addKeyHandler(int key, const KeyHandler &handler) {
+	keyHandlers_[key] = handler;
+}
+
+void GLApp::setMaxFrames(uint32_t numFrames) {
+	maxFrames_ = numFrames;
+}
+
+void GLApp::setFixedTimeStep(double seconds) {
+	fixedTimeStep_ = seconds;
+}
+
+void GLApp::setVSync(bool enabled) {
+	if (window_) {
+		glfwSwapInterval(enabled ? 1 : 0);
+	}
+}
+
+void GLApp::run(const DrawFrameHandler &drawFrame) {
+	while (!shouldClose()) {
+		EASY_BLOCK("Frame");
+		// Examples may bind their own framebuffers, every frame starts on the one that stands for the window
+		if (headless_) {
+			headless_->bindFramebuffer();
+		}
+		const float ratio = resizeViewport();
+		drawFrame(ratio);
+
+		// With vsync on this is where the CPU waits for the GPU. Offscreen we only make sure the commands are submitted
+		EASY_BLOCK("SwapBuffers");
+		if (window_) {
+			glfwSwapBuffers(window_);
+		}
+		else {
+			glFlush();
+		}
+		EASY_END_BLOCK;
+		if (window_) {
+			glfwPollEvents();
+		}
+
+		++frameIndex_;
+		if (maxFrames_ > 0 && frameIndex_ >= maxFrames_) {
+			close();
+		}
+	}
+}
+
+void GLApp::close() {
+	closed_ = true;
+	if (window_) {
+		glfwSetWindowShouldClose(window_, GLFW_TRUE);
+	}
+}
+
+bool GLApp::shouldClose() const {
+	return closed_ || (window_ && glfwWindowShouldClose(window_));
+}
+
+double GLApp::getTime() const {
+	if (fixedTimeStep_ > 0.0) {
+		return frameIndex_ * fixedTimeStep_;
+	}
+	if (headless_) {
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime_).count();
+	}
+	return glfwGetTime();
+}
+
+void GLApp::getFramebufferSize(int &width, int &height) const {
+	if (headless_) {
+		width = headless_->getWidth();
+		height = headless_->getHeight();
+		return;
+	}
+	glfwGetFramebufferSize(window_, &width, &height);
+}
+
+void GLApp::onKey(GLFWwindow *window, int key, int scancode, int action, int mods) {
+	if (action != GLFW_PRESS) {
+		return;
+	}
+
+	if (key == GLFW_KEY_ESCAPE) {
+		glfwSetWindowShouldClose(window, GLFW_TRUE);
+		return;
+	}
+
+	GLApp *app = (GLApp*)glfwGetWindowUserPointer(window);
+	auto handler = app->keyHandlers_.find(key);
+	if (handler != app->keyHandlers_.end()) {
+		handler->second();
+	}
+}
+
+float GLApp::resizeViewport() {
+	int width, height;
+	getFramebufferSize(width, height);
+	glViewport(0, 0, width, height);
+	return width / (float)height;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <glad/gl.h>
+#include <GLFW/glfw3.h>
+#include <stdint.h>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <memory>
+
+class GLHeadlessContext;
+
+// Owns the window and the OpenGL context and drives the frame loop of an example.
+// Any GL resource has to be destroyed before the GLApp that created the context, so declare them after it.
+// The headless backend creates the context without a window, see GLHeadlessContext, and renders into an offscreen
+// framebuffer of the same size with the same frame loop. There are no key presses then, so pair it with setMaxFrames.
+class GLApp {
+public:
+	using KeyHandler = std::function<void()>;
+	// Called once per frame after the viewport has been resized to the framebuffer. Receives its aspect ratio
+	using DrawFrameHandler = std::function<void(float)>;
+
+	enum class Backend { Window, Headless };
+
+	GLApp(int majorVersion, int minorVersion, int profile, int width, int height, const char *title, Backend backend = Backend::Window);
+	~GLApp();
+
+	GLApp(const GLApp&) = delete;
+	GLApp& operator=(const GLApp&) = delete;
+
+	// Registers a handler called when key is pressed. Escape always closes the window
+	void addKeyHandler(int key, const KeyHandler &handler);
+	// run() returns after numFrames frames. 0, the default, runs until the window is closed
+	void setMaxFrames(uint32_t numFrames);
+	// getTime() then returns the number of frames run times seconds instead of the real time, so every run
+	// animates the same frames whatever the frame rate. 0, the default, goes back to the real time
+	void setFixedTimeStep(double seconds);
+	// On by default. Has no effect with the headless backend, which never waits for a display
+	void setVSync(bool enabled);
+	void run(const DrawFrameHandler &drawFrame);
+	// Makes run() return after the current frame
+	void close();
+
+	// Null with the headless backend
+	GLFWwindow *getWindow() const { return window_; }
+	bool isHeadless() const { return headless_ != nullptr; }
+	double getTime() const;
+	// Frames completed since run() was called
+	uint64_t getFrameIndex() const { return frameIndex_; }
+	void getFramebufferSize(int &width, int &height) const;
+
+private:
+	static void onKey(GLFWwindow *window, int key, int scancode, int action, int mods);
+	float resizeViewport();
+	bool shouldClose() const;
+
+	GLFWwindow *window_ = nullptr;
+	std::unique_ptr<GLHeadlessContext> headless_;
+	std::chrono::steady_clock::time_point startTime_;
+	uint32_t maxFrames_ = 0;
+	uint64_t frameIndex_ = 0;
+	double fixedTimeStep_ = 0.0;
+	bool closed_ = false;
+	std::map<int, KeyHandler> keyHandlers_;
+};
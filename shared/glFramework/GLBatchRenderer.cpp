@@ -0,0 +1,163 @@
+#include "shared/glFramework/GLBatchRenderer.h"
+
+#include "shared/EasyProfilerWrapper.h"
+#include "shared/glFramework/GLStateCache.h"
+#include <stdio.h>
+
+GLBatchRenderer::GLBatchRenderer(VertexFormat vertexFormat, uint32_t maxDrawsPerFrame)
+	: vertexFormat_(vertexFormat)
+	, vertexStride_(getVertexFormatStride(vertexFormat))
+	, maxDraws_(maxDrawsPerFrame)
+	, indirectBuffer_(maxDrawsPerFrame * sizeof(DrawElementsIndirectCommand), 1, 3, GL_DRAW_INDIRECT_BUFFER)
+	, drawDataBuffer_(maxDrawsPerFrame * sizeof(glm::mat4), 1, 3, GL_SHADER_STORAGE_BUFFER) {
+	commands_.reserve(maxDrawsPerFrame);
+	models_.reserve(maxDrawsPerFrame);
+}
+
+GLBatchRenderer::~GLBatchRenderer() {
+	destroyBuffers();
+}
+
+GLBatchRenderer::MeshHandle GLBatchRenderer::addMeshes(const MeshData &meshData) {
+	if (meshData.getVertexFormat() != vertexFormat_) {
+		fprintf(stderr, "The vertex format of the meshes doesn't match the one of the batch renderer\n");
+		return (MeshHandle)meshes_.size();
+	}
+
+	// Vertices are copied as they are, indices are widened to 32 bits so every draw uses the same index type
+	const MeshHandle first = (MeshHandle)meshes_.size();
+	const uint32_t baseVertex = (uint32_t)(vertexData_.size() / vertexStride_);
+	const uint32_t baseIndex = (uint32_t)indexData_.size();
+	vertexData_.insert(vertexData_.end(), meshData.getVertexData(), meshData.getVertexData() + meshData.getVertexDataSize());
+	const size_t numIndices = meshData.getIndexDataSize() / meshData.getIndexSize();
+	for (size_t i = 0; i < numIndices; ++i) {
+		indexData_.push_back(meshData.getIndex(i));
+	}
+
+	for (uint32_t i = 0; i < meshData.getNumMeshes(); ++i) {
+		Mesh mesh = meshData.getMesh(i);
+		mesh.vertexOffset += baseVertex;
+		mesh.indexOffset += baseIndex;
+		for (uint32_t lod = 0; lod <= mesh.lodCount; ++lod) {
+			mesh.lodOffset[lod] += baseIndex;
+		}
+		meshes_.push_back(mesh);
+	}
+	meshesChanged_ = true;
+	return first;
+}
+
+GLBatchRenderer::MeshHandle GLBatchRenderer::addMesh(const void *vertices, uint32_t vertexCount, const uint32_t *indices, uint32_t indexCount) {
+	const uint32_t baseIndex = (uint32_t)indexData_.size();
+	const Mesh mesh = {
+		.vertexOffset = (uint32_t)(vertexData_.size() / vertexStride_),
+		.vertexCount = vertexCount,
+		.indexOffset = baseIndex,
+		.indexCount = indexCount,
+		.materialIndex = 0,
+		.lodCount = 1,
+		.lodOffset = { baseIndex, baseIndex + indexCount },
+		.lodError = { 0.0f },
+		.boundingSphere = { 0.0f, 0.0f, 0.0f, 0.0f }
+	};
+	const uint8_t *bytes = (const uint8_t*)vertices;
+	vertexData_.insert(vertexData_.end(), bytes, bytes + (size_t)vertexCount * vertexStride_);
+	indexData_.insert(indexData_.end(), indices, indices + indexCount);
+	meshes_.push_back(mesh);
+	meshesChanged_ = true;
+	return (MeshHandle)meshes_.size() - 1;
+}
+
+void GLBatchRenderer::beginFrame() {
+	if (meshesChanged_) {
+		createBuffers();
+		meshesChanged_ = false;
+	}
+	indirectBuffer_.beginFrame();
+	drawDataBuffer_.beginFrame();
+	commands_.clear();
+	models_.clear();
+}
+
+void GLBatchRenderer::draw(MeshHandle meshHandle, const glm::mat4 &model, uint32_t lod) {
+	if (commands_.size() == maxDraws_) {
+		fprintf(stderr, "Too many draws for the batch renderer, the limit is %u per frame\n", maxDraws_);
+		return;
+	}
+
+	// baseInstance is the index of the draw too, for shaders that prefer gl_BaseInstance over gl_DrawID
+	const Mesh &mesh = meshes_[meshHandle];
+	commands_.push_back({
+		.count = mesh.getLODIndexCount(lod),
+		.instanceCount = 1,
+		.firstIndex = mesh.lodOffset[lod],
+		.baseVertex = (GLint)mesh.vertexOffset,
+		.baseInstance = (GLuint)commands_.size()
+	});
+	models_.push_back(model);
+}
+
+void GLBatchRenderer::endFrame(GLStateCache *stateCache) {
+	EASY_FUNCTION();
+	if (!commands_.empty()) {
+		const GLRingBuffer::Allocation commands = indirectBuffer_.upload(commands_.data(), commands_.size() * sizeof(DrawElementsIndirectCommand));
+		const GLRingBuffer::Allocation models = drawDataBuffer_.upload(models_.data(), models_.size() * sizeof(glm::mat4));
+
+		// With a buffer bound to GL_DRAW_INDIRECT_BUFFER the indirect parameter is an offset into it
+		if (stateCache) {
+			drawDataBuffer_.bindRange(kDrawDataBinding, models, *stateCache);
+			stateCache->bindVertexArray(vao_);
+			stateCache->bindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBuffer_.getHandle());
+		}
+		else {
+			drawDataBuffer_.bindRange(kDrawDataBinding, models);
+			glBindVertexArray(vao_);
+			glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBuffer_.getHandle());
+		}
+		glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (const void*)(intptr_t)commands.offset, (GLsizei)commands_.size(), 0);
+		// Code that doesn't know about the indirect buffer shouldn't find it bound. Through the cache everyone does
+		if (!stateCache) {
+			glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+		}
+	}
+	indirectBuffer_.endFrame();
+	drawDataBuffer_.endFrame();
+}
+
+void GLBatchRenderer::createBuffers() {
+	EASY_FUNCTION();
+	destroyBuffers();
+
+	// The meshes never change after being added so immutable storage is all we need
+	glCreateBuffers(1, &vertexBuffer_);
+	glNamedBufferStorage(vertexBuffer_, vertexData_.size(), vertexData_.data(), 0);
+	glCreateBuffers(1, &indexBuffer_);
+	glNamedBufferStorage(indexBuffer_, indexData_.size() * sizeof(uint32_t), indexData_.data(), 0);
+
+	glCreateVertexArrays(1, &vao_);
+	glVertexArrayVertexBuffer(vao_, 0, vertexBuffer_, 0, vertexStride_);
+	glVertexArrayElementBuffer(vao_, indexBuffer_);
+	for (GLuint attribute = 0; attribute < 3; ++attribute) {
+		glEnableVertexArrayAttrib(vao_, attribute);
+		glVertexArrayAttribBinding(vao_, attribute, 0);
+	}
+	if (vertexFormat_ == VertexFormat::Quantized) {
+		glVertexArrayAttribFormat(vao_, 0, 3, GL_HALF_FLOAT, GL_FALSE, 0);
+		glVertexArrayAttribFormat(vao_, 1, 3, GL_BYTE, GL_TRUE, 8);
+		glVertexArrayAttribFormat(vao_, 2, 2, GL_HALF_FLOAT, GL_FALSE, 12);
+	}
+	else {
+		glVertexArrayAttribFormat(vao_, 0, 3, GL_FLOAT, GL_FALSE, 0);
+		glVertexArrayAttribFormat(vao_, 1, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float));
+		glVertexArrayAttribFormat(vao_, 2, 2, GL_FLOAT, GL_FALSE, 6 * sizeof(float));
+	}
+}
+
+void GLBatchRenderer::destroyBuffers() {
+	if (vao_) {
+		glDeleteVertexArrays(1, &vao_);
+		glDeleteBuffers(1, &vertexBuffer_);
+		glDeleteBuffers(1, &indexBuffer_);
+		vao_ = vertexBuffer_ = indexBuffer_ = 0;
+	}
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "shared/glFramework/GLRingBuffer.h"
+#include "shared/scene/MeshData.h"
+#include <glad/gl.h>
+#include <glm/glm.hpp>
+#include <stdint.h>
+#include <vector>
+
+class GLStateCache;
+
+// Draws any number of meshes with a single glMultiDrawElementsIndirect per frame.
+// Every mesh lives in one shared vertex buffer and one shared index buffer. The draws of a frame are written
+// as DrawElementsIndirectCommands into a persistently mapped indirect buffer and their model matrices into a
+// storage buffer bound to kDrawDataBinding, which the vertex shader indexes with gl_DrawID:
+//
+//   layout (std430, binding = 1) readonly buffer DrawData { mat4 models[]; };
+//   gl_Position = viewProj * models[gl_DrawID] * vec4(pos, 1.0);
+//
+// Vertex attributes are position at location 0, normal at location 1 and uv at location 2.
+class GLBatchRenderer {
+public:
+	using MeshHandle = uint32_t;
+	static const GLuint kDrawDataBinding = 1;
+
+	// All meshes share vertexFormat. maxDrawsPerFrame sizes the indirect and storage buffers
+	GLBatchRenderer(VertexFormat vertexFormat, uint32_t maxDrawsPerFrame);
+	~GLBatchRenderer();
+
+	GLBatchRenderer(const GLBatchRenderer&) = delete;
+	GLBatchRenderer& operator=(const GLBatchRenderer&) = delete;
+
+	// Adds every mesh of meshData with all its LODs. Returns the handle of the first one, the rest follow it
+	MeshHandle addMeshes(const MeshData &meshData);
+	// Adds a single mesh from interleaved vertices in the vertex format of the renderer
+	MeshHandle addMesh(const void *vertices, uint32_t vertexCount, const uint32_t *indices, uint32_t indexCount);
+	// The mesh with its offsets into the shared buffers, what selectLOD needs
+	const Mesh &getMesh(MeshHandle mesh) const { return meshes_[mesh]; }
+
+	// Meshes added since the last frame are uploaded here, adding meshes in the middle of a frame isn't supported
+	void beginFrame();
+	// Queues a draw, nothing reaches the GPU until endFrame
+	void draw(MeshHandle mesh, const glm::mat4 &model, uint32_t lod = 0);
+	// Submits every draw queued this frame with the program currently bound.
+	// With a stateCache its bindings go through it and are left in place for the next frame
+	void endFrame(GLStateCache *stateCache = nullptr);
+
+	uint32_t getNumDraws() const { return (uint32_t)commands_.size(); }
+
+private:
+	// The layout glMultiDrawElementsIndirect reads
+	struct DrawElementsIndirectCommand {
+		GLuint count;
+		GLuint instanceCount;
+		GLuint firstIndex;
+		GLint baseVertex;
+		GLuint baseInstance;
+	};
+
+	void createBuffers();
+	void destroyBuffers();
+
+	VertexFormat vertexFormat_;
+	uint32_t vertexStride_;
+	uint32_t maxDraws_;
+
+	// Kept on the CPU until the next beginFrame uploads them
+	std::vector<Mesh> meshes_;
+	std::vector<uint8_t> vertexData_;
+	std::vector<uint32_t> indexData_;
+	bool meshesChanged_ = false;
+
+	GLuint vao_ = 0;
+	GLuint vertexBuffer_ = 0;
+	GLuint indexBuffer_ = 0;
+	GLRingBuffer indirectBuffer_;
+	GLRingBuffer drawDataBuffer_;
+
+	std::vector<DrawElementsIndirectCommand> commands_;
+	std::vector<glm::mat4> models_;
+};
@@ -0,0 +1,179 @@
+#include "shared/glFramework/GLBenchmark.h"
+
+#include "shared/CommandLine.h"
+#include "shared/glFramework/GLApp.h"
+#include "shared/glFramework/GLRingBuffer.h"
+#include "shared/glFramework/GLStateCache.h"
+#include <rapidjson/prettywriter.h>
+#include <rapidjson/stringbuffer.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+
+using JsonWriter = rapidjson::PrettyWriter<rapidjson::StringBuffer>;
+
+// The warm-up frames are timed under their own name so their results, which arrive a few frames late, never
+// end up among the measured ones
+static const char *kWarmupScope = "Warmup";
+static const char *kFrameScope = "Frame";
+
+// Nearest rank percentile of sorted samples, p in [0, 1]
+static double getPercentile(const std::vector<double> &sorted, double p) {
+	const size_t rank = (size_t)ceil(p * sorted.size());
+	return sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1];
+}
+
+static void writeStatistics(JsonWriter &writer, const char *key, std::vector<double> samples) {
+	writer.Key(key);
+	writer.StartObject();
+	writer.Key("samples");
+	writer.Uint((unsigned)samples.size());
+	if (!samples.empty()) {
+		std::sort(samples.begin(), samples.end());
+		double sum = 0.0;
+		for (double sample : samples) {
+			sum += sample;
+		}
+		writer.Key("min");
+		writer.Double(samples.front());
+		writer.Key("median");
+		writer.Double(getPercentile(samples, 0.5));
+		writer.Key("p99");
+		writer.Double(getPercentile(samples, 0.99));
+		writer.Key("max");
+		writer.Double(samples.back());
+		writer.Key("mean");
+		writer.Double(sum / samples.size());
+	}
+	writer.EndObject();
+}
+
+bool GLBenchmark::parseSettings(const CommandLine &commandLine, Settings &settings) {
+	if (!commandLine.hasOption("benchmark")) {
+		return false;
+	}
+
+	settings.warmupFrames = (uint32_t)std::max<int64_t>(0, commandLine.getInt("warmup-frames", settings.warmupFrames));
+	settings.frames = (uint32_t)std::max<int64_t>(1, commandLine.getInt("benchmark-frames", settings.frames));
+	settings.outputPath = commandLine.getString("benchmark-output", "");
+	return true;
+}
+
+GLBenchmark::GLBenchmark(GLApp &app, const char *name, const Settings &settings)
+	: app_(app)
+	, name_(name)
+	, settings_(settings)
+	, gpuTimers_(1) {
+	if (settings_.outputPath.empty()) {
+		settings_.outputPath = name_ + "_benchmark.json";
+	}
+	cpuFrameMs_.reserve(settings_.frames);
+	gpuFrameMs_.reserve(settings_.frames);
+
+	app_.setFixedTimeStep(settings_.timeStep);
+	app_.setVSync(false);
+	gpuTimers_.setResultHandler([this](const char *scope, double ms) {
+		if (strcmp(scope, kFrameScope) == 0) {
+			gpuFrameMs_.push_back(ms);
+		}
+	});
+}
+
+void GLBenchmark::beginFrame() {
+	gpuTimers_.beginFrame();
+	gpuTimers_.begin(isMeasuring() ? kFrameScope : kWarmupScope);
+	frameStartBytes_ = GLRingBuffer::getTotalAllocatedBytes();
+	if (stateCache_) {
+		frameStartIssued_ = stateCache_->getStats().issued;
+		frameStartFiltered_ = stateCache_->getStats().filtered;
+	}
+	frameStart_ = std::chrono::steady_clock::now();
+}
+
+void GLBenchmark::addDrawCalls(uint32_t drawCalls, uint32_t draws) {
+	if (isMeasuring()) {
+		drawCalls_ += drawCalls;
+		draws_ += draws;
+	}
+}
+
+void GLBenchmark::trackStateCache(const GLStateCache &stateCache) {
+	stateCache_ = &stateCache;
+}
+
+void GLBenchmark::endFrame() {
+	const std::chrono::steady_clock::time_point frameEnd = std::chrono::steady_clock::now();
+	gpuTimers_.end();
+	gpuTimers_.endFrame();
+	if (finished_) {
+		return;
+	}
+
+	if (isMeasuring()) {
+		cpuFrameMs_.push_back(std::chrono::duration<double, std::milli>(frameEnd - frameStart_).count());
+		uploadedBytes_ += GLRingBuffer::getTotalAllocatedBytes() - frameStartBytes_;
+		if (stateCache_) {
+			stateCallsIssued_ += stateCache_->getStats().issued - frameStartIssued_;
+			stateCallsFiltered_ += stateCache_->getStats().filtered - frameStartFiltered_;
+		}
+	}
+	if (++frameIndex_ == settings_.warmupFrames + settings_.frames) {
+		gpuTimers_.flush();
+		writeReport();
+		finished_ = true;
+	}
+}
+
+void GLBenchmark::writeReport() {
+	int width, height;
+	app_.getFramebufferSize(width, height);
+	const double numFrames = (double)settings_.frames;
+
+	rapidjson::StringBuffer buffer;
+	JsonWriter writer(buffer);
+	writer.StartObject();
+	writer.Key("name");
+	writer.String(name_.c_str());
+	writer.Key("renderer");
+	writer.String((const char*)glGetString(GL_RENDERER));
+	writer.Key("version");
+	writer.String((const char*)glGetString(GL_VERSION));
+	writer.Key("width");
+	writer.Int(width);
+	writer.Key("height");
+	writer.Int(height);
+	writer.Key("warmupFrames");
+	writer.Uint(settings_.warmupFrames);
+	writer.Key("frames");
+	writer.Uint(settings_.frames);
+	writer.Key("timeStep");
+	writer.Double(settings_.timeStep);
+	writeStatistics(writer, "cpuFrameMs", cpuFrameMs_);
+	writeStatistics(writer, "gpuFrameMs", gpuFrameMs_);
+	writer.Key("gpuFramesDropped");
+	writer.Uint(gpuTimers_.getNumDroppedFrames());
+	writer.Key("drawCallsPerFrame");
+	writer.Double(drawCalls_ / numFrames);
+	writer.Key("drawsPerFrame");
+	writer.Double(draws_ / numFrames);
+	writer.Key("uploadedBytesPerFrame");
+	writer.Double(uploadedBytes_ / numFrames);
+	if (stateCache_) {
+		writer.Key("stateCallsIssuedPerFrame");
+		writer.Double(stateCallsIssued_ / numFrames);
+		writer.Key("stateCallsFilteredPerFrame");
+		writer.Double(stateCallsFiltered_ / numFrames);
+	}
+	writer.EndObject();
+
+	FILE *file = fopen(settings_.outputPath.c_str(), "wb");
+	if (!file) {
+		fprintf(stderr, "Can't open %s to write the benchmark report\n", settings_.outputPath.c_str());
+		return;
+	}
+	fputs(buffer.GetString(), file);
+	fputs("\n", file);
+	fclose(file);
+	printf("Benchmark of %u frames written to %s\n", settings_.frames, settings_.outputPath.c_str());
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "shared/glFramework/GLGpuTimers.h"
+#include <stdint.h>
+#include <chrono>
+#include <string>
+#include <vector>
+
+class CommandLine;
+class GLApp;
+class GLStateCache;
+
+// Runs an example for a fixed number of frames and writes statistics about them to a JSON file, so runs can be
+// compared against each other by scripts. The app switches to a fixed time step and vsync is turned off, so every
+// run renders the exact same frames as fast as it can. The first frames are a warm-up that isn't measured, they
+// cover shader compiles, texture uploads and the driver settling down.
+// For every measured frame we record the CPU time from beginFrame to endFrame, the GPU time of the commands issued
+// in between, the draw calls reported with addDrawCalls and the bytes allocated from ring buffers. The report has
+// the min, median, p99 and mean of the frame times and the per frame averages of the rest.
+class GLBenchmark {
+public:
+	struct Settings {
+		uint32_t warmupFrames = 100;
+		uint32_t frames = 1000;
+		// How much the time seen by the example advances every frame
+		double timeStep = 1.0 / 60.0;
+		// <name>_benchmark.json when empty
+		std::string outputPath;
+	};
+
+	// Reads the settings from --benchmark [--warmup-frames N] [--benchmark-frames N] [--benchmark-output <file.json>]
+	static bool parseSettings(const CommandLine &commandLine, Settings &settings);
+
+	// name identifies the example in the report
+	GLBenchmark(GLApp &app, const char *name, const Settings &settings);
+
+	GLBenchmark(const GLBenchmark&) = delete;
+	GLBenchmark& operator=(const GLBenchmark&) = delete;
+
+	// Call it first thing in the frame and endFrame last, everything in between is measured
+	void beginFrame();
+	// draws counts every draw of a multi-draw call on its own
+	void addDrawCalls(uint32_t drawCalls, uint32_t draws);
+	// Adds the calls stateCache issued and filtered during the measured frames to the report
+	void trackStateCache(const GLStateCache &stateCache);
+	// Writes the report after the last measured frame
+	void endFrame();
+	// True once the report has been written, the example should close then
+	bool isFinished() const { return finished_; }
+
+private:
+	bool isMeasuring() const { return frameIndex_ >= settings_.warmupFrames; }
+	void writeReport();
+
+	GLApp &app_;
+	std::string name_;
+	Settings settings_;
+	uint32_t frameIndex_ = 0;
+	bool finished_ = false;
+
+	GLGpuTimers gpuTimers_;
+	std::chrono::steady_clock::time_point frameStart_;
+	uint64_t frameStartBytes_ = 0;
+	std::vector<double> cpuFrameMs_;
+	std::vector<double> gpuFrameMs_;
+	uint64_t drawCalls_ = 0;
+	uint64_t draws_ = 0;
+	uint64_t uploadedBytes_ = 0;
+
+	const GLStateCache *stateCache_ = nullptr;
+	uint64_t frameStartIssued_ = 0;
+	uint64_t frameStartFiltered_ = 0;
+	uint64_t stateCallsIssued_ = 0;
+	uint64_t stateCallsFiltered_ = 0;
+};
@@ -0,0 +1,79 @@
+#include "shared/glFramework/GLFrameCapture.h"
+
+#include "shared/CommandLine.h"
+#include "stb/stb_image_write.h"
+#include <algorithm>
+
+// Enough buffers to keep a few frames in flight on the GPU while the workers are encoding others
+static const uint32_t kNumReadbackBuffers = 8;
+
+static uint32_t getNumWorkers(GLFrameCapture::Output output) {
+	// Raw frames have to be appended in order so a single worker writes them.
+	// PNG encoding is the bottleneck of image sequences so we use every core available
+	if (output == GLFrameCapture::Output::RawFile) {
+		return 1;
+	}
+	return std::max(2u, std::thread::hardware_concurrency()) - 1;
+}
+
+bool GLFrameCapture::parseSettings(const CommandLine &commandLine, Settings &settings) {
+	if (!commandLine.hasOption("capture")) {
+		return false;
+	}
+
+	settings.path = commandLine.getString("capture", "capture");
+	settings.every = (uint32_t)std::max<int64_t>(1, commandLine.getInt("capture-every", 1));
+	settings.firstFrame = (uint64_t)commandLine.getInt("capture-first", 0);
+	settings.lastFrame = commandLine.hasOption("capture-last") ? (uint64_t)commandLine.getInt("capture-last", 0) : UINT64_MAX;
+	settings.output = commandLine.hasOption("capture-raw") ? Output::RawFile : Output::ImageSequence;
+	return true;
+}
+
+GLFrameCapture::GLFrameCapture(const Settings &settings)
+	: settings_(settings)
+	, readbackQueue_(kNumReadbackBuffers, getNumWorkers(settings.output)) {
+	if (settings_.output == Output::RawFile) {
+		rawFile_ = fopen(settings_.path.c_str(), "wb");
+		if (!rawFile_) {
+			fprintf(stderr, "Can't open %s to capture frames\n", settings_.path.c_str());
+		}
+	}
+}
+
+GLFrameCapture::~GLFrameCapture() {
+	// Every pending frame has to be written before closing the file
+	readbackQueue_.flush();
+	if (rawFile_) {
+		fclose(rawFile_);
+	}
+}
+
+void GLFrameCapture::endFrame(int width, int height) {
+	const uint64_t frame = frameIndex_++;
+	readbackQueue_.update();
+
+	if (frame < settings_.firstFrame || frame > settings_.lastFrame || (frame - settings_.firstFrame) % settings_.every != 0) {
+		return;
+	}
+
+	if (settings_.output == Output::RawFile) {
+		if (!rawFile_) {
+			return;
+		}
+		if (frame == settings_.firstFrame) {
+			printf("Capturing %dx%d RGBA8 frames to %s\n", width, height, settings_.path.c_str());
+		}
+		FILE *file = rawFile_;
+		readbackQueue_.requestReadback(width, height, [file](const uint8_t *pixels, int width, int height) {
+			fwrite(pixels, 4, (size_t)width * height, file);
+		});
+	}
+	else {
+		char fileName[32];
+		snprintf(fileName, sizeof(fileName), "_%06llu.png", (unsigned long long)frame);
+		const std::string path = settings_.path + fileName;
+		readbackQueue_.requestReadback(width, height, [path](const uint8_t *pixels, int width, int height) {
+			stbi_write_png(path.c_str(), width, height, 4, pixels, 0);
+		});
+	}
+}
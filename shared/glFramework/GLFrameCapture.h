@@ -0,0 +1,50 @@
+#pragma once
+
+#include "shared/glFramework/GLReadbackQueue.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+
+class CommandLine;
+
+// Records a sequence of frames to disk for offline videos and regression dumps.
+// Frames are read back through a pool of PBOs so capturing doesn't stall the frame loop
+// unless the workers can't keep up with the encoding.
+class GLFrameCapture {
+public:
+	enum class Output {
+		// One PNG per frame named <path>_<frame>.png
+		ImageSequence,
+		// Every frame appended to <path> as raw RGBA8 pixels, bottom row first
+		RawFile
+	};
+
+	struct Settings {
+		// Records one every `every` frames inside [firstFrame, lastFrame]
+		uint32_t every = 1;
+		uint64_t firstFrame = 0;
+		uint64_t lastFrame = UINT64_MAX;
+		Output output = Output::ImageSequence;
+		std::string path;
+	};
+
+	// Reads the settings from --capture <path> [--capture-every N] [--capture-first N] [--capture-last N] [--capture-raw]
+	static bool parseSettings(const CommandLine &commandLine, Settings &settings);
+
+	explicit GLFrameCapture(const Settings &settings);
+	~GLFrameCapture();
+
+	GLFrameCapture(const GLFrameCapture&) = delete;
+	GLFrameCapture& operator=(const GLFrameCapture&) = delete;
+
+	// Call it once per frame after drawing and before swapping buffers
+	void endFrame(int width, int height);
+	// True once the last frame of the range has been recorded
+	bool isFinished() const { return frameIndex_ > settings_.lastFrame; }
+
+private:
+	Settings settings_;
+	uint64_t frameIndex_ = 0;
+	FILE *rawFile_ = nullptr;
+	GLReadbackQueue readbackQueue_;
+};
@@ -0,0 +1,156 @@
+#include "shared/glFramework/GLGpuTimers.h"
+
+#include "shared/EasyProfilerWrapper.h"
+#include <stdio.h>
+#include <string.h>
+
+#if BUILD_WITH_EASY_PROFILER
+#include <string>
+#include <unordered_map>
+#endif
+
+// Marks the scopes opened after the frame ran out of queries
+static const uint32_t kNoScope = UINT32_MAX;
+
+#if BUILD_WITH_EASY_PROFILER
+
+// Easy Profiler needs a descriptor for every kind of block, GPU scopes register theirs when their name first shows up
+static const profiler::BaseBlockDescriptor *getBlockDescriptor(const char *name) {
+	static std::unordered_map<std::string, const profiler::BaseBlockDescriptor*> descriptors;
+	auto it = descriptors.find(name);
+	if (it == descriptors.end()) {
+		it = descriptors.emplace(name, nullptr).first;
+		it->second = profiler::registerDescription(profiler::ON, it->first.c_str(), it->first.c_str(), __FILE__, __LINE__,
+			profiler::BlockType::Block, profiler::colors::Orange, true);
+	}
+	return it->second;
+}
+
+static int64_t gpuToCpuTime(const int64_t gpuTime, const int64_t frameCpuTime, const int64_t frameGpuTime) {
+	// GPU timestamps are in nanoseconds, the profiler clock ticks at its own rate
+	static const double ticksPerNanosecond = 1e9 / (double)profiler::toNanoseconds(1000000000ull);
+	return frameCpuTime + (int64_t)((gpuTime - frameGpuTime) * ticksPerNanosecond);
+}
+
+#endif
+
+GLGpuTimers::GLGpuTimers(uint32_t maxScopesPerFrame, uint32_t numFrames)
+	: frames_(numFrames)
+	, maxScopes_(maxScopesPerFrame) {
+	for (Frame &frame : frames_) {
+		frame.queries.resize(maxScopesPerFrame * 2);
+		glCreateQueries(GL_TIMESTAMP, (GLsizei)frame.queries.size(), frame.queries.data());
+		frame.scopes.reserve(maxScopesPerFrame);
+	}
+	openScopes_.reserve(maxScopesPerFrame);
+}
+
+GLGpuTimers::~GLGpuTimers() {
+	for (Frame &frame : frames_) {
+		glDeleteQueries((GLsizei)frame.queries.size(), frame.queries.data());
+	}
+}
+
+void GLGpuTimers::beginFrame() {
+	Frame &frame = frames_[currentFrame_];
+	if (frame.numQueries > 0) {
+		readResults(frame);
+	}
+	frame.scopes.clear();
+	frame.numQueries = 0;
+	openScopes_.clear();
+
+#if BUILD_WITH_EASY_PROFILER
+	// GL_TIMESTAMP is the GPU time once the commands issued so far are processed, it doesn't wait for them
+	frame.cpuTime = (int64_t)profiler::now();
+	glGetInteger64v(GL_TIMESTAMP, &frame.gpuTime);
+#endif
+}
+
+void GLGpuTimers::endFrame() {
+	if (!openScopes_.empty()) {
+		fprintf(stderr, "%zu GPU timer scopes are still open at the end of the frame\n", openScopes_.size());
+		openScopes_.clear();
+	}
+	currentFrame_ = (currentFrame_ + 1) % frames_.size();
+}
+
+void GLGpuTimers::flush() {
+	glFinish();
+	// From the oldest frame to the newest, so the results are read in the order the frames were drawn
+	for (size_t i = 0; i < frames_.size(); ++i) {
+		Frame &frame = frames_[(currentFrame_ + i) % frames_.size()];
+		if (frame.numQueries > 0) {
+			readResults(frame);
+		}
+		frame.scopes.clear();
+		frame.numQueries = 0;
+	}
+}
+
+void GLGpuTimers::begin(const char *name) {
+	Frame &frame = frames_[currentFrame_];
+	if (frame.scopes.size() == maxScopes_) {
+		openScopes_.push_back(kNoScope);
+		return;
+	}
+	openScopes_.push_back((uint32_t)frame.scopes.size());
+	frame.scopes.push_back({ .name = name, .beginQuery = frame.numQueries, .endQuery = 0 });
+	glQueryCounter(frame.queries[frame.numQueries++], GL_TIMESTAMP);
+}
+
+void GLGpuTimers::end() {
+	if (openScopes_.empty()) {
+		return;
+	}
+	const uint32_t scope = openScopes_.back();
+	openScopes_.pop_back();
+	if (scope == kNoScope) {
+		return;
+	}
+	Frame &frame = frames_[currentFrame_];
+	frame.scopes[scope].endQuery = frame.numQueries;
+	glQueryCounter(frame.queries[frame.numQueries++], GL_TIMESTAMP);
+}
+
+void GLGpuTimers::readResults(Frame &frame) {
+	// Queries complete in order, once the last one is available all of them are
+	GLuint available = GL_FALSE;
+	glGetQueryObjectuiv(frame.queries[frame.numQueries - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+	if (available == GL_FALSE) {
+		++numDroppedFrames_;
+		return;
+	}
+
+	for (const Scope &scope : frame.scopes) {
+		// Scopes left open at the end of the frame
+		if (scope.endQuery <= scope.beginQuery) {
+			continue;
+		}
+		GLuint64 begin = 0, end = 0;
+		glGetQueryObjectui64v(frame.queries[scope.beginQuery], GL_QUERY_RESULT, &begin);
+		glGetQueryObjectui64v(frame.queries[scope.endQuery], GL_QUERY_RESULT, &end);
+
+		Timing &timing = getTiming(scope.name);
+		timing.lastMs = (double)(end - begin) * 1e-6;
+		timing.averageMs = timing.averageMs == 0.0 ? timing.lastMs : timing.averageMs + (timing.lastMs - timing.averageMs) / 30.0;
+		if (resultHandler_) {
+			resultHandler_(scope.name, timing.lastMs);
+		}
+
+#if BUILD_WITH_EASY_PROFILER
+		profiler::storeBlock(getBlockDescriptor(scope.name), scope.name,
+			gpuToCpuTime((int64_t)begin, frame.cpuTime, frame.gpuTime), gpuToCpuTime((int64_t)end, frame.cpuTime, frame.gpuTime));
+#endif
+	}
+}
+
+GLGpuTimers::Timing &GLGpuTimers::getTiming(const char *name) {
+	for (Timing &timing : timings_) {
+		if (strcmp(timing.name, name) == 0) {
+			return timing;
+		}
+	}
+	timings_.push_back({ .name = name });
+	return timings_.back();
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <glad/gl.h>
+#include <stdint.h>
+#include <functional>
+#include <vector>
+
+// Measures how long the GPU spends on parts of a frame with GL_TIMESTAMP queries.
+// Every frame gets its own set of queries, used round-robin like GLRingBuffer regions, so the results of a frame
+// are read numFrames - 1 frames later when the GPU is long done with them. Results that still aren't available by
+// then are dropped instead of waited for, so timing never stalls the pipeline.
+// With BUILD_WITH_EASY_PROFILER every scope also shows up in Easy Profiler as a block of the render thread,
+// next to the CPU blocks, with the GPU timestamps converted to the CPU clock.
+//
+//   timers.beginFrame();
+//   { GLGpuTimerScope scope(timers, "Solid"); glDrawArrays(...); }
+//   timers.endFrame();
+class GLGpuTimers {
+public:
+	struct Timing {
+		// The name the scope was opened with
+		const char *name;
+		double lastMs = 0.0;
+		// Exponential moving average over roughly the last 30 frames
+		double averageMs = 0.0;
+	};
+
+	// Receives every result as it's read, for callers that need each sample and not only the averages
+	using ResultHandler = std::function<void(const char *name, double ms)>;
+
+	explicit GLGpuTimers(uint32_t maxScopesPerFrame = 32, uint32_t numFrames = 4);
+	~GLGpuTimers();
+
+	GLGpuTimers(const GLGpuTimers&) = delete;
+	GLGpuTimers& operator=(const GLGpuTimers&) = delete;
+
+	// Reads the results of the frame whose queries are about to be reused
+	void beginFrame();
+	void endFrame();
+	// Waits for the GPU and reads the results of every frame still pending. Call it between frames at the end
+	// of a run, otherwise the results of its last numFrames - 1 frames are never read
+	void flush();
+
+	// Scopes can be nested. name has to outlive the timers, string literals are what this is meant for
+	void begin(const char *name);
+	void end();
+
+	// One entry per scope name in the order they were first seen
+	const std::vector<Timing> &getTimings() const { return timings_; }
+	// Frames whose results weren't ready in time, which means the GPU is more than numFrames - 1 frames behind
+	uint32_t getNumDroppedFrames() const { return numDroppedFrames_; }
+	void setResultHandler(const ResultHandler &handler) { resultHandler_ = handler; }
+
+private:
+	struct Scope {
+		const char *name;
+		uint32_t beginQuery;
+		uint32_t endQuery;
+	};
+
+	struct Frame {
+		std::vector<GLuint> queries;
+		std::vector<Scope> scopes;
+		uint32_t numQueries = 0;
+		// The CPU and GPU clocks read at the start of the frame, to move GPU timestamps onto the CPU timeline
+		int64_t cpuTime = 0;
+		int64_t gpuTime = 0;
+	};
+
+	void readResults(Frame &frame);
+	Timing &getTiming(const char *name);
+
+	std::vector<Frame> frames_;
+	uint32_t currentFrame_ = 0;
+	uint32_t maxScopes_;
+	// Indices into the scopes of the current frame
+	std::vector<uint32_t> openScopes_;
+	std::vector<Timing> timings_;
+	uint32_t numDroppedFrames_ = 0;
+	ResultHandler resultHandler_;
+};
+
+// Times the GPU commands issued during its lifetime
+class GLGpuTimerScope {
+public:
+	GLGpuTimerScope(GLGpuTimers &timers, const char *name)
+		: timers_(timers) {
+		timers_.begin(name);
+	}
+	~GLGpuTimerScope() {
+		timers_.end();
+	}
+
+	GLGpuTimerScope(const GLGpuTimerScope&) = delete;
+	GLGpuTimerScope& operator=(const GLGpuTimerScope&) = delete;
+
+private:
+	GLGpuTimers &timers_;
+};
@@ -0,0 +1,136 @@
+#include "shared/glFramework/GLHeadlessContext.h"
+
+#include <GLFW/glfw3.h>
+#include <stdio.h>
+#include <string.h>
+
+#if BUILD_WITH_EGL
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+#if BUILD_WITH_EGL
+
+static bool hasExtension(EGLDisplay display, const char *name) {
+	const char *extensions = eglQueryString(display, EGL_EXTENSIONS);
+	return extensions && strstr(extensions, name) != nullptr;
+}
+
+GLHeadlessContext::GLHeadlessContext(int majorVersion, int minorVersion, int profile, int width, int height)
+	: width_(width)
+	, height_(height) {
+	// The surfaceless platform doesn't need a display server at all
+	EGLDisplay display = EGL_NO_DISPLAY;
+	PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+	if (getPlatformDisplay && hasExtension(EGL_NO_DISPLAY, "EGL_MESA_platform_surfaceless")) {
+		display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+	}
+	if (display == EGL_NO_DISPLAY) {
+		display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+	}
+	EGLint eglMajor = 0, eglMinor = 0;
+	if (display == EGL_NO_DISPLAY || !eglInitialize(display, &eglMajor, &eglMinor)) {
+		fprintf(stderr, "Can't initialize EGL, error 0x%x\n", eglGetError());
+		return;
+	}
+	display_ = display;
+
+	const EGLint configAttributes[] = {
+		EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+		EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+		EGL_NONE
+	};
+	EGLConfig config = nullptr;
+	EGLint numConfigs = 0;
+	if (!eglBindAPI(EGL_OPENGL_API) || !eglChooseConfig(display, configAttributes, &config, 1, &numConfigs) || numConfigs == 0) {
+		fprintf(stderr, "EGL %d.%d has no desktop OpenGL config\n", eglMajor, eglMinor);
+		return;
+	}
+
+	const EGLint contextAttributes[] = {
+		EGL_CONTEXT_MAJOR_VERSION, majorVersion,
+		EGL_CONTEXT_MINOR_VERSION, minorVersion,
+		EGL_CONTEXT_OPENGL_PROFILE_MASK, profile == GLFW_OPENGL_COMPAT_PROFILE ?
+			EGL_CONTEXT_OPENGL_COMPATIBILITY_PROFILE_BIT : EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+		EGL_NONE
+	};
+	context_ = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttributes);
+	if (!context_) {
+		// llvmpipe implements everything the examples use but may advertise an older version
+		fprintf(stderr, "Can't create an OpenGL %d.%d context with EGL, error 0x%x. With Mesa try MESA_GL_VERSION_OVERRIDE=%d.%d\n",
+			majorVersion, minorVersion, eglGetError(), majorVersion, minorVersion);
+		return;
+	}
+
+	// Without EGL_KHR_surfaceless_context the context needs some surface to be made current
+	if (!hasExtension(display, "EGL_KHR_surfaceless_context")) {
+		const EGLint surfaceAttributes[] = { EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE };
+		surface_ = eglCreatePbufferSurface(display, config, surfaceAttributes);
+	}
+	if (!eglMakeCurrent(display, surface_, surface_, context_)) {
+		fprintf(stderr, "Can't make the EGL context current, error 0x%x\n", eglGetError());
+		return;
+	}
+	gladLoadGL(getProcAddress);
+
+	glCreateRenderbuffers(1, &colorBuffer_);
+	glNamedRenderbufferStorage(colorBuffer_, GL_RGBA8, width, height);
+	glCreateRenderbuffers(1, &depthBuffer_);
+	glNamedRenderbufferStorage(depthBuffer_, GL_DEPTH24_STENCIL8, width, height);
+	glCreateFramebuffers(1, &framebuffer_);
+	glNamedFramebufferRenderbuffer(framebuffer_, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer_);
+	glNamedFramebufferRenderbuffer(framebuffer_, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depthBuffer_);
+	if (glCheckNamedFramebufferStatus(framebuffer_, GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+		fprintf(stderr, "The offscreen framebuffer is incomplete\n");
+		glDeleteFramebuffers(1, &framebuffer_);
+		framebuffer_ = 0;
+		return;
+	}
+	bindFramebuffer();
+	printf("Headless OpenGL context on %s\n", (const char*)glGetString(GL_RENDERER));
+}
+
+GLHeadlessContext::~GLHeadlessContext() {
+	if (framebuffer_) {
+		glDeleteFramebuffers(1, &framebuffer_);
+	}
+	if (colorBuffer_) {
+		glDeleteRenderbuffers(1, &colorBuffer_);
+		glDeleteRenderbuffers(1, &depthBuffer_);
+	}
+	if (display_) {
+		eglMakeCurrent(display_, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+		if (surface_) {
+			eglDestroySurface(display_, surface_);
+		}
+		if (context_) {
+			eglDestroyContext(display_, context_);
+		}
+		eglTerminate(display_);
+	}
+}
+
+GLADapiproc GLHeadlessContext::getProcAddress(const char *name) {
+	return (GLADapiproc)eglGetProcAddress(name);
+}
+
+#else
+
+GLHeadlessContext::GLHeadlessContext(int majorVersion, int minorVersion, int profile, int width, int height)
+	: width_(width)
+	, height_(height) {
+	fprintf(stderr, "Headless rendering needs EGL, which this build doesn't have\n");
+}
+
+GLHeadlessContext::~GLHeadlessContext() {
+}
+
+GLADapiproc GLHeadlessContext::getProcAddress(const char *name) {
+	return nullptr;
+}
+
+#endif
+
+void GLHeadlessContext::bindFramebuffer() const {
+	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+}
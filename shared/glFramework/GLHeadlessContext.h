@@ -0,0 +1,39 @@
+#pragma once
+
+#include <glad/gl.h>
+
+// An OpenGL context without a window, for machines without a display or a GPU.
+// It's created with EGL on its surfaceless platform, which Mesa (llvmpipe included) and the NVIDIA driver support,
+// and falls back to the default EGL display with a 1x1 pbuffer. Since there is no default framebuffer worth
+// drawing to, everything is rendered into an offscreen framebuffer of the requested size.
+// Only available on Linux builds that found EGL, elsewhere isValid() is always false.
+class GLHeadlessContext {
+public:
+	// profile is GLFW_OPENGL_CORE_PROFILE or GLFW_OPENGL_COMPAT_PROFILE, as for windows
+	GLHeadlessContext(int majorVersion, int minorVersion, int profile, int width, int height);
+	~GLHeadlessContext();
+
+	GLHeadlessContext(const GLHeadlessContext&) = delete;
+	GLHeadlessContext& operator=(const GLHeadlessContext&) = delete;
+
+	// The context is current and GL is loaded
+	bool isValid() const { return framebuffer_ != 0; }
+	// Binds the offscreen framebuffer for drawing and reading, as the default framebuffer would be
+	void bindFramebuffer() const;
+
+	int getWidth() const { return width_; }
+	int getHeight() const { return height_; }
+
+	// Loads GL functions through EGL, what glfwGetProcAddress is for windows
+	static GLADapiproc getProcAddress(const char *name);
+
+private:
+	void *display_ = nullptr;
+	void *surface_ = nullptr;
+	void *context_ = nullptr;
+	int width_;
+	int height_;
+	GLuint framebuffer_ = 0;
+	GLuint colorBuffer_ = 0;
+	GLuint depthBuffer_ = 0;
+};
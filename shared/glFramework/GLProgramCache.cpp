@@ -0,0 +1,123 @@
+#include "shared/glFramework/GLProgramCache.h"
+
+#include "shared/EasyProfilerWrapper.h"
+#include "shared/Hash.h"
+#include "shared/MappedFile.h"
+#include <stdio.h>
+#include <string.h>
+#include <filesystem>
+#include <vector>
+
+// Bump it whenever the file layout changes
+static const uint32_t kCacheVersion = 1;
+static const uint32_t kCacheMagic = 0x47525043; // "CPRG"
+
+namespace {
+
+struct CacheHeader {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t binaryFormat;
+	uint32_t binarySize;
+};
+
+}
+
+GLProgramCache::GLProgramCache(const std::string &directory)
+	: directory_(directory) {
+	// Some drivers don't support any binary format at all
+	GLint numFormats = 0;
+	glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &numFormats);
+	enabled_ = !directory_.empty() && numFormats > 0;
+	if (!enabled_) {
+		return;
+	}
+
+	driverHash_ = kHashSeed;
+	for (GLenum name : { GL_VENDOR, GL_RENDERER, GL_VERSION }) {
+		const char *value = (const char*)glGetString(name);
+		if (value) {
+			driverHash_ = hashBytes(value, strlen(value), driverHash_);
+		}
+	}
+
+	std::error_code error;
+	std::filesystem::create_directories(directory_, error);
+}
+
+uint64_t GLProgramCache::getKey(const char *const *sources, size_t numSources) const {
+	uint64_t key = driverHash_;
+	for (size_t i = 0; i < numSources; ++i) {
+		// The length goes in too so moving text from one stage to the next changes the key
+		const size_t length = strlen(sources[i]);
+		key = hashValue(length, key);
+		key = hashBytes(sources[i], length, key);
+	}
+	return key;
+}
+
+bool GLProgramCache::load(uint64_t key, GLuint program) const {
+	if (!enabled_) {
+		return false;
+	}
+	EASY_FUNCTION();
+
+	MappedFile file(getPath(key));
+	if (!file.isValid() || file.getSize() < sizeof(CacheHeader)) {
+		return false;
+	}
+	const CacheHeader *header = (const CacheHeader*)file.getData();
+	if (header->magic != kCacheMagic || header->version != kCacheVersion || sizeof(CacheHeader) + header->binarySize > file.getSize()) {
+		return false;
+	}
+
+	glProgramBinary(program, header->binaryFormat, header + 1, (GLsizei)header->binarySize);
+	GLint isLinked = 0;
+	glGetProgramiv(program, GL_LINK_STATUS, &isLinked);
+	return isLinked == GL_TRUE;
+}
+
+void GLProgramCache::store(uint64_t key, GLuint program) const {
+	if (!enabled_) {
+		return;
+	}
+	EASY_FUNCTION();
+
+	GLint length = 0;
+	glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+	if (length <= 0) {
+		return;
+	}
+
+	std::vector<uint8_t> data(sizeof(CacheHeader) + length);
+	GLenum binaryFormat = 0;
+	glGetProgramBinary(program, length, &length, &binaryFormat, data.data() + sizeof(CacheHeader));
+	const CacheHeader header = { .magic = kCacheMagic, .version = kCacheVersion, .binaryFormat = binaryFormat, .binarySize = (uint32_t)length };
+	memcpy(data.data(), &header, sizeof(header));
+
+	// Written to a temporary file first so a crash never leaves a truncated binary behind
+	const std::string path = getPath(key);
+	const std::string temporaryPath = path + ".tmp";
+	FILE *file = fopen(temporaryPath.c_str(), "wb");
+	if (!file) {
+		fprintf(stderr, "Can't write program cache entry %s\n", temporaryPath.c_str());
+		return;
+	}
+	const size_t size = sizeof(CacheHeader) + length;
+	const bool written = fwrite(data.data(), 1, size, file) == size;
+	fclose(file);
+
+	std::error_code error;
+	if (written) {
+		std::filesystem::rename(temporaryPath, path, error);
+	}
+	if (!written || error) {
+		std::filesystem::remove(temporaryPath, error);
+	}
+}
+
+std::string GLProgramCache::getPath(uint64_t key) const {
+	char name[24];
+	snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)key);
+	return (std::filesystem::path(directory_) / name).string();
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <glad/gl.h>
+#include <stdint.h>
+#include <string>
+
+// Stores linked programs with glGetProgramBinary so the next run loads them with glProgramBinary
+// instead of compiling and linking their shaders again.
+// Binaries only work on the driver that produced them, so entries are keyed by the shader sources
+// together with the vendor, renderer and version strings. A driver update just misses the cache,
+// and a binary the driver still rejects is reported by load() so the caller compiles the program.
+class GLProgramCache {
+public:
+	// An empty directory disables the cache
+	explicit GLProgramCache(const std::string &directory = ".cache/programs");
+
+	bool isEnabled() const { return enabled_; }
+	uint64_t getKey(const char *const *sources, size_t numSources) const;
+	// Loads the binary stored for key into program. Returns false when there is none or the driver rejects it
+	bool load(uint64_t key, GLuint program) const;
+	// The program has to be linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT set
+	void store(uint64_t key, GLuint program) const;
+
+private:
+	std::string getPath(uint64_t key) const;
+
+	std::string directory_;
+	bool enabled_ = false;
+	uint64_t driverHash_ = 0;
+};
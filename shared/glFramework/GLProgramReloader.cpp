@@ -0,0 +1,56 @@
+#include "shared/glFramework/GLProgramReloader.h"
+
+#include "shared/ShaderCompiler.h"
+#include <stdio.h>
+#include <filesystem>
+
+static bool isSameFile(const std::string &a, const std::string &b) {
+	return std::filesystem::path(a).lexically_normal() == std::filesystem::path(b).lexically_normal();
+}
+
+GLProgramReloader::GLProgramReloader(const std::string &directory)
+	: watcher_(directory) {
+}
+
+void GLProgramReloader::add(GLProgram &program) {
+	if (!program.getCache()) {
+		fprintf(stderr, "Only programs built from shader files can be reloaded\n");
+		return;
+	}
+	programs_.push_back({ .program = &program, .next = nullptr });
+}
+
+void GLProgramReloader::update() {
+	for (const std::string &fileName : watcher_.poll()) {
+		// The watcher also sees the SPIR-V and temporary files the tools write next to the shaders
+		if (!isShaderFile(fileName.c_str())) {
+			continue;
+		}
+		for (Entry &entry : programs_) {
+			const GLProgram &program = *entry.program;
+			if (isSameFile(fileName, program.getVertexFileName()) || isSameFile(fileName, program.getFragmentFileName())) {
+				// A version still being linked is outdated already, the new one replaces it
+				printf("Reloading %s + %s\n", program.getVertexFileName().c_str(), program.getFragmentFileName().c_str());
+				entry.next = std::make_unique<GLProgram>(*program.getCache(),
+					program.getVertexFileName().c_str(), program.getFragmentFileName().c_str());
+			}
+		}
+	}
+
+	for (Entry &entry : programs_) {
+		if (!entry.next || !entry.next->isReady()) {
+			continue;
+		}
+		if (entry.next->waitUntilLinked()) {
+			// The examples bind their program once, so the new version takes the place of the old one if it was bound
+			GLint current = 0;
+			glGetIntegerv(GL_CURRENT_PROGRAM, &current);
+			entry.program->swap(*entry.next);
+			if ((GLuint)current == entry.next->getHandle()) {
+				entry.program->useProgram();
+			}
+		}
+		// Either the old version or the one that failed
+		entry.next.reset();
+	}
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "shared/FileWatcher.h"
+#include "shared/glFramework/GLShader.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+// Rebuilds programs while the app runs whenever one of their shader files changes.
+// Only the programs that use the changed file are rebuilt, and since they go through their GLProgramCache
+// a file saved without changes, or changed back, loads its old binary instead of compiling again.
+// The new version is linked in the background and swapped in by update() once the driver is done with it,
+// the old one keeps drawing until then. A version that fails to compile is reported and dropped.
+class GLProgramReloader {
+public:
+	explicit GLProgramReloader(const std::string &directory = "data/shaders");
+
+	// The program has to be built from shader files under the watched folder
+	void add(GLProgram &program);
+	// Call it between frames. It never waits for the driver when it supports GL_KHR_parallel_shader_compile
+	void update();
+
+private:
+	struct Entry {
+		GLProgram *program;
+		// The version being linked, if any
+		std::unique_ptr<GLProgram> next;
+	};
+
+	FileWatcher watcher_;
+	std::vector<Entry> programs_;
+};
@@ -0,0 +1,161 @@
+#include "shared/glFramework/GLReadbackQueue.h"
+
+GLReadbackQueue::GLReadbackQueue(uint32_t numBuffers, uint32_t numWorkers) {
+	for (uint32_t i = 0; i < numBuffers; ++i) {
+		slots_.push_back(std::make_unique<Slot>());
+	}
+	for (uint32_t i = 0; i < numWorkers; ++i) {
+		workers_.emplace_back(&GLReadbackQueue::workerLoop, this);
+	}
+}
+
+GLReadbackQueue::~GLReadbackQueue() {
+	flush();
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		quit_ = true;
+	}
+	jobAvailable_.notify_all();
+	for (std::thread &worker : workers_) {
+		worker.join();
+	}
+
+	for (auto &slot : slots_) {
+		if (slot->pbo) {
+			glUnmapNamedBuffer(slot->pbo);
+			glDeleteBuffers(1, &slot->pbo);
+		}
+	}
+}
+
+void GLReadbackQueue::requestReadback(int width, int height, const Consumer &consumer) {
+	Slot *slot = acquireSlot();
+	resizeSlot(*slot, (GLsizeiptr)width * height * 4);
+	slot->width = width;
+	slot->height = height;
+	slot->consumer = consumer;
+
+	// With a buffer bound to GL_PIXEL_PACK_BUFFER the last parameter is an offset and the call doesn't wait for the GPU
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, slot->pbo);
+	glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	slot->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		slot->state = SlotState::Copying;
+	}
+	copying_.push_back(slot);
+}
+
+void GLReadbackQueue::update() {
+	submitFinished(false);
+}
+
+void GLReadbackQueue::flush() {
+	while (!copying_.empty()) {
+		submitFinished(true);
+	}
+
+	std::unique_lock<std::mutex> lock(mutex_);
+	slotReleased_.wait(lock, [this]() {
+		for (const auto &slot : slots_) {
+			if (slot->state != SlotState::Free) {
+				return false;
+			}
+		}
+		return true;
+	});
+}
+
+GLReadbackQueue::Slot *GLReadbackQueue::acquireSlot() {
+	while (true) {
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			for (auto &slot : slots_) {
+				if (slot->state == SlotState::Free) {
+					return slot.get();
+				}
+			}
+			if (copying_.empty()) {
+				// Every slot is being consumed so the worker will release one eventually
+				slotReleased_.wait(lock);
+				continue;
+			}
+		}
+		// Some copies are still in flight so we wait for the oldest one
+		submitFinished(true);
+	}
+}
+
+void GLReadbackQueue::resizeSlot(Slot &slot, GLsizeiptr size) {
+	if (slot.capacity >= size) {
+		return;
+	}
+
+	if (slot.pbo) {
+		glUnmapNamedBuffer(slot.pbo);
+		glDeleteBuffers(1, &slot.pbo);
+	}
+
+	// We keep the buffer persistently mapped so the worker can read it without any GL call.
+	// GL_CLIENT_STORAGE_BIT hints the driver to place it in system memory, which is faster for readbacks
+	const GLbitfield flags = GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+	glCreateBuffers(1, &slot.pbo);
+	glNamedBufferStorage(slot.pbo, size, nullptr, flags | GL_CLIENT_STORAGE_BIT);
+	slot.mappedPtr = (uint8_t*)glMapNamedBufferRange(slot.pbo, 0, size, flags);
+	slot.capacity = size;
+}
+
+void GLReadbackQueue::submitFinished(bool wait) {
+	while (!copying_.empty()) {
+		Slot *slot = copying_.front();
+		// When waiting we only block on the oldest readback, the rest are checked without waiting
+		const GLuint64 timeout = wait ? 1000000 : 0;
+		GLbitfield waitFlags = wait ? GL_SYNC_FLUSH_COMMANDS_BIT : 0;
+		GLenum result;
+		do {
+			result = glClientWaitSync(slot->fence, waitFlags, timeout);
+			waitFlags = 0;
+		} while (wait && result == GL_TIMEOUT_EXPIRED);
+
+		if (result == GL_TIMEOUT_EXPIRED) {
+			return;
+		}
+
+		glDeleteSync(slot->fence);
+		slot->fence = nullptr;
+		copying_.pop_front();
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			slot->state = SlotState::Consuming;
+			consuming_.push_back(slot);
+		}
+		jobAvailable_.notify_one();
+		wait = false;
+	}
+}
+
+void GLReadbackQueue::workerLoop() {
+	while (true) {
+		Slot *slot;
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			jobAvailable_.wait(lock, [this]() { return quit_ || !consuming_.empty(); });
+			if (consuming_.empty()) {
+				return;
+			}
+			slot = consuming_.front();
+			consuming_.pop_front();
+		}
+
+		slot->consumer(slot->mappedPtr, slot->width, slot->height);
+
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			slot->consumer = nullptr;
+			slot->state = SlotState::Free;
+		}
+		slotReleased_.notify_all();
+	}
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <glad/gl.h>
+#include <stdint.h>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Reads the framebuffer back asynchronously using a pool of pixel-pack buffers (PBOs).
+// glReadPixels into a PBO returns immediately, we put a fence after it and only when the GPU has
+// signaled it a few frames later the pixels are handed to a worker thread that consumes them
+// (e.g. encodes a PNG) so the render thread never waits for the copy nor the encoding.
+// With a single worker consumers run in request order, with more of them they run concurrently.
+class GLReadbackQueue {
+public:
+	// Runs on the worker thread. pixels are RGBA8 rows, bottom row first as returned by glReadPixels,
+	// and are only valid during the call
+	using Consumer = std::function<void(const uint8_t *pixels, int width, int height)>;
+
+	explicit GLReadbackQueue(uint32_t numBuffers = 3, uint32_t numWorkers = 1);
+	~GLReadbackQueue();
+
+	GLReadbackQueue(const GLReadbackQueue&) = delete;
+	GLReadbackQueue& operator=(const GLReadbackQueue&) = delete;
+
+	// Copies the current read framebuffer into a free PBO. If all of them are busy it waits for the oldest one.
+	void requestReadback(int width, int height, const Consumer &consumer);
+	// Hands the readbacks whose copy has finished to the worker thread. Call it once per frame
+	void update();
+	// Waits until every requested readback has been consumed
+	void flush();
+
+private:
+	enum class SlotState { Free, Copying, Consuming };
+
+	struct Slot {
+		GLuint pbo = 0;
+		GLsizeiptr capacity = 0;
+		uint8_t *mappedPtr = nullptr;
+		GLsync fence = nullptr;
+		int width = 0;
+		int height = 0;
+		Consumer consumer;
+		SlotState state = SlotState::Free;
+	};
+
+	Slot *acquireSlot();
+	void resizeSlot(Slot &slot, GLsizeiptr size);
+	void submitFinished(bool wait);
+	void workerLoop();
+
+	std::vector<std::unique_ptr<Slot>> slots_;
+	// Slots whose GPU copy is in flight, in request order
+	std::deque<Slot*> copying_;
+
+	// Everything below is shared with the worker thread and protected by mutex_
+	std::mutex mutex_;
+	std::condition_variable jobAvailable_;
+	std::condition_variable slotReleased_;
+	std::deque<Slot*> consuming_;
+	bool quit_ = false;
+	std::vector<std::thread> workers_;
+};
@@ -0,0 +1,96 @@
+#include "shared/glFramework/GLRingBuffer.h"
+
+#include "shared/glFramework/GLStateCache.h"
+#include <stdio.h>
+#include <string.h>
+
+uint64_t GLRingBuffer::totalAllocatedBytes_ = 0;
+
+GLRingBuffer::GLRingBuffer(GLsizeiptr blockSize, uint32_t blocksPerFrame, uint32_t numFrames, GLenum target)
+	: target_(target)
+	, numFrames_(numFrames)
+	, fences_(numFrames, nullptr) {
+
+	// Bound ranges must start at a multiple of the implementation offset alignment (usually 256 bytes for uniforms)
+	const GLenum alignmentQuery = target == GL_SHADER_STORAGE_BUFFER ?
+		GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT : GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT;
+	glGetIntegerv(alignmentQuery, &alignment_);
+	frameSize_ = getAlignedSize(blockSize) * blocksPerFrame;
+
+	// GL_MAP_PERSISTENT_BIT lets us keep the buffer mapped while the GPU uses it and
+	// GL_MAP_COHERENT_BIT makes our writes visible without explicit flushes
+	const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+	glCreateBuffers(1, &handle_);
+	glNamedBufferStorage(handle_, frameSize_ * numFrames_, nullptr, flags);
+	mappedPtr_ = (uint8_t*)glMapNamedBufferRange(handle_, 0, frameSize_ * numFrames_, flags);
+}
+
+GLRingBuffer::~GLRingBuffer() {
+	for (GLsync fence : fences_) {
+		if (fence) {
+			glDeleteSync(fence);
+		}
+	}
+	glUnmapNamedBuffer(handle_);
+	glDeleteBuffers(1, &handle_);
+}
+
+void GLRingBuffer::beginFrame() {
+	GLsync &fence = fences_[currentFrame_];
+	if (fence) {
+		// We only flush on the first try, after that the fence is guaranteed to signal eventually
+		GLbitfield waitFlags = GL_SYNC_FLUSH_COMMANDS_BIT;
+		while (true) {
+			const GLenum result = glClientWaitSync(fence, waitFlags, 1000000);
+			if (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED || result == GL_WAIT_FAILED) {
+				break;
+			}
+			waitFlags = 0;
+		}
+		glDeleteSync(fence);
+		fence = nullptr;
+	}
+	frameOffset_ = 0;
+}
+
+void GLRingBuffer::endFrame() {
+	fences_[currentFrame_] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	currentFrame_ = (currentFrame_ + 1) % numFrames_;
+}
+
+GLRingBuffer::Allocation GLRingBuffer::allocate(GLsizeiptr size) {
+	const GLsizeiptr alignedSize = getAlignedSize(size);
+	if (frameOffset_ + alignedSize > frameSize_) {
+		fprintf(stderr, "Ring buffer out of space: %lld bytes requested, %lld available\n",
+			(long long)size, (long long)(frameSize_ - frameOffset_));
+		return Allocation();
+	}
+
+	Allocation allocation;
+	allocation.offset = currentFrame_ * frameSize_ + frameOffset_;
+	allocation.size = size;
+	allocation.ptr = mappedPtr_ + allocation.offset;
+	frameOffset_ += alignedSize;
+	totalAllocatedBytes_ += size;
+	return allocation;
+}
+
+GLRingBuffer::Allocation GLRingBuffer::upload(const void *data, GLsizeiptr size) {
+	Allocation allocation = allocate(size);
+	if (allocation.ptr) {
+		memcpy(allocation.ptr, data, size);
+	}
+	return allocation;
+}
+
+void GLRingBuffer::bindRange(GLuint index, const Allocation &allocation) const {
+	glBindBufferRange(target_, index, handle_, allocation.offset, allocation.size);
+}
+
+void GLRingBuffer::bindRange(GLuint index, const Allocation &allocation, GLStateCache &stateCache) const {
+	stateCache.bindBufferRange(target_, index, handle_, allocation.offset, allocation.size);
+}
+
+GLsizeiptr GLRingBuffer::getAlignedSize(GLsizeiptr size) const {
+	return (size + alignment_ - 1) / alignment_ * alignment_;
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <glad/gl.h>
+#include <stdint.h>
+#include <vector>
+
+class GLStateCache;
+
+// A persistently mapped buffer split in numFrames regions that are used in a round-robin fashion.
+// Each frame writes its data to its own region while the GPU is still reading the previous ones,
+// so we never have to wait for the driver to copy our data like glNamedBufferSubData does.
+// A fence is placed at the end of each frame and we only wait on it when we wrap around to that region again.
+class GLRingBuffer {
+public:
+	// A sub-allocation inside the current frame region, ready to be used with glBindBufferRange
+	struct Allocation {
+		GLintptr offset = 0;
+		GLsizeiptr size = 0;
+		void *ptr = nullptr;
+	};
+
+	// blockSize is the size of the biggest block we'll allocate and blocksPerFrame how many of them we need each frame.
+	// Every block is padded to the offset alignment required by target.
+	GLRingBuffer(GLsizeiptr blockSize, uint32_t blocksPerFrame, uint32_t numFrames = 3, GLenum target = GL_UNIFORM_BUFFER);
+	~GLRingBuffer();
+
+	GLRingBuffer(const GLRingBuffer&) = delete;
+	GLRingBuffer& operator=(const GLRingBuffer&) = delete;
+
+	// Waits until the GPU has finished reading the region we are going to write to
+	void beginFrame();
+	// Places a fence after the commands that use the current region and moves to the next one
+	void endFrame();
+
+	Allocation allocate(GLsizeiptr size);
+	Allocation upload(const void *data, GLsizeiptr size);
+	void bindRange(GLuint index, const Allocation &allocation) const;
+	// Skips the bind when the range is already bound to index
+	void bindRange(GLuint index, const Allocation &allocation, GLStateCache &stateCache) const;
+
+	GLuint getHandle() const { return handle_; }
+	GLsizeiptr getAlignedSize(GLsizeiptr size) const;
+	GLsizeiptr getFrameSize() const { return frameSize_; }
+	// Bytes still available in the current frame region
+	GLsizeiptr getFreeSize() const { return frameSize_ - frameOffset_; }
+	// Bytes allocated from every ring buffer since startup, which is what the CPU has written for the GPU to read.
+	// Only meant for the render thread, like the rest of the class
+	static uint64_t getTotalAllocatedBytes() { return totalAllocatedBytes_; }
+
+private:
+	GLuint handle_ = 0;
+	GLenum target_;
+	GLint alignment_ = 1;
+	GLsizeiptr frameSize_ = 0;
+	GLsizeiptr frameOffset_ = 0;
+	uint32_t numFrames_;
+	uint32_t currentFrame_ = 0;
+	uint8_t *mappedPtr_ = nullptr;
+	std::vector<GLsync> fences_;
+
+	static uint64_t totalAllocatedBytes_;
+};
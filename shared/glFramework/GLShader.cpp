@@ -0,0 +1,248 @@
+#include "shared/glFramework/GLShader.h"
+
+#include "shared/EasyProfilerWrapper.h"
+#include "shared/MappedFile.h"
+#include "shared/ShaderCompiler.h"
+#include "shared/glFramework/GLProgramCache.h"
+#include <stdio.h>
+#include <string.h>
+#include <filesystem>
+#include <string>
+#include <utility>
+
+// GL_NONE when the extension isn't one of ShaderCompiler.h
+static GLenum getShaderType(const char *fileName) {
+	const std::string extension = std::filesystem::path(fileName).extension().string();
+	if (extension == ".vert") {
+		return GL_VERTEX_SHADER;
+	}
+	if (extension == ".tesc") {
+		return GL_TESS_CONTROL_SHADER;
+	}
+	if (extension == ".tese") {
+		return GL_TESS_EVALUATION_SHADER;
+	}
+	if (extension == ".geom") {
+		return GL_GEOMETRY_SHADER;
+	}
+	if (extension == ".frag") {
+		return GL_FRAGMENT_SHADER;
+	}
+	if (extension == ".comp") {
+		return GL_COMPUTE_SHADER;
+	}
+	return GL_NONE;
+}
+
+// Taken from GL_KHR_parallel_shader_compile, which our glad loader doesn't include
+#ifndef GL_MAX_SHADER_COMPILER_THREADS_KHR
+#define GL_MAX_SHADER_COMPILER_THREADS_KHR 0x91B0
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+typedef void (GLAD_API_PTR *PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)(GLuint count);
+
+static bool parallelShaderCompile = false;
+
+static bool hasExtension(const char *name) {
+	GLint numExtensions = 0;
+	glGetIntegerv(GL_NUM_EXTENSIONS, &numExtensions);
+	for (GLint i = 0; i < numExtensions; ++i) {
+		if (strcmp((const char*)glGetStringi(GL_EXTENSIONS, i), name) == 0) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void enableParallelShaderCompile(GLADloadfunc load) {
+	// The ARB version of the extension has the same entry point and enums under another suffix
+	PFNGLMAXSHADERCOMPILERTHREADSKHRPROC maxShaderCompilerThreads = nullptr;
+	if (hasExtension("GL_KHR_parallel_shader_compile")) {
+		maxShaderCompilerThreads = (PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)load("glMaxShaderCompilerThreadsKHR");
+	}
+	else if (hasExtension("GL_ARB_parallel_shader_compile")) {
+		maxShaderCompilerThreads = (PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)load("glMaxShaderCompilerThreadsARB");
+	}
+	parallelShaderCompile = maxShaderCompilerThreads != nullptr;
+	if (parallelShaderCompile) {
+		// 0xFFFFFFFF lets the driver use as many threads as it sees fit
+		maxShaderCompilerThreads(0xFFFFFFFF);
+	}
+}
+
+bool isParallelShaderCompileEnabled() {
+	return parallelShaderCompile;
+}
+
+static bool checkCompileStatus(GLuint shader) {
+	GLint isCompiled = 0;
+	glGetShaderiv(shader, GL_COMPILE_STATUS, &isCompiled);
+	if (isCompiled == GL_FALSE)
+	{
+		GLint maxLength = 0;
+		glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &maxLength);
+
+		// The maxLength includes the NULL character
+		GLchar *errorLog = new GLchar[(int)maxLength];
+		glGetShaderInfoLog(shader, maxLength, &maxLength, errorLog);
+
+		// The label is the file name GLShader loaded the shader from, shaders built from a string have none
+		GLchar label[256] = {};
+		glGetObjectLabel(GL_SHADER, shader, sizeof(label), nullptr, label);
+		fprintf(stderr, "Error compiling shader %s: %s\n", label[0] ? label : "from source", errorLog);
+		delete[] errorLog;
+	}
+	return isCompiled == GL_TRUE;
+}
+
+GLShader::GLShader(GLenum type, const char *source)
+	: type_(type)
+	, handle_(glCreateShader(type)) {
+	compile(source);
+}
+
+GLShader::GLShader(const char *fileName)
+	: type_(getShaderType(fileName))
+	, handle_(type_ != GL_NONE ? glCreateShader(type_) : 0) {
+	EASY_FUNCTION();
+	if (type_ == GL_NONE) {
+		fprintf(stderr, "Unknown shader type for %s\n", fileName);
+		return;
+	}
+	glObjectLabel(GL_SHADER, handle_, -1, fileName);
+
+	// SPIR-V skips the GLSL front end of the driver, specializing it only picks the entry point
+	if (isShaderSPIRVUpToDate(fileName)) {
+		MappedFile spirv(getShaderSPIRVPath(fileName));
+		if (spirv.isValid()) {
+			glShaderBinary(1, &handle_, GL_SHADER_BINARY_FORMAT_SPIR_V, spirv.getData(), (GLsizei)spirv.getSize());
+			glSpecializeShader(handle_, "main", 0, nullptr, nullptr);
+			return;
+		}
+	}
+
+	std::string source;
+	if (!readShaderFile(fileName, source)) {
+		fprintf(stderr, "Can't read shader %s\n", fileName);
+		return;
+	}
+	compile(source.c_str());
+}
+
+void GLShader::compile(const char *source) {
+	// The compile status isn't checked here, asking for it would wait for the compile to finish.
+	// GLProgram checks it once the program is linked
+	glShaderSource(handle_, 1, &source, nullptr);
+	glCompileShader(handle_);
+}
+
+GLShader::~GLShader() {
+	// A shader still attached to a program that is being linked lives until GLProgram detaches it
+	glDeleteShader(handle_);
+}
+
+GLProgram::GLProgram(const GLShader &a, const GLShader &b)
+	: handle_(glCreateProgram()) {
+	link(a, b);
+}
+
+GLProgram::GLProgram(const GLProgramCache &cache, const char *vertexFileName, const char *fragmentFileName)
+	: handle_(glCreateProgram())
+	, cache_(&cache)
+	, vertexFileName_(vertexFileName)
+	, fragmentFileName_(fragmentFileName) {
+	// The key comes from the GLSL sources, the SPIR-V built from them links into the same program
+	std::string vertexSource, fragmentSource;
+	readShaderFile(vertexFileName, vertexSource);
+	readShaderFile(fragmentFileName, fragmentSource);
+	const char *sources[] = { vertexSource.c_str(), fragmentSource.c_str() };
+	cacheKey_ = cache.getKey(sources, 2);
+	if (cache.load(cacheKey_, handle_)) {
+		linked_ = true;
+		return;
+	}
+
+	// The hint has to be set before linking for glGetProgramBinary to return anything.
+	// The binary is stored once the link finishes, see waitUntilLinked
+	glProgramParameteri(handle_, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+	GLShader vs(vertexFileName);
+	GLShader fs(fragmentFileName);
+	link(vs, fs);
+}
+
+void GLProgram::link(const GLShader &a, const GLShader &b) {
+	// With parallel shader compilation glLinkProgram returns right away and the driver links on its own threads.
+	// The shaders stay attached until we have checked how their compile went
+	glAttachShader(handle_, a.getHandle());
+	glAttachShader(handle_, b.getHandle());
+	glLinkProgram(handle_);
+	pending_ = true;
+}
+
+bool GLProgram::isReady() const {
+	if (!pending_ || !parallelShaderCompile) {
+		return true;
+	}
+	GLint isCompleted = 0;
+	glGetProgramiv(handle_, GL_COMPLETION_STATUS_KHR, &isCompleted);
+	return isCompleted == GL_TRUE;
+}
+
+bool GLProgram::waitUntilLinked() {
+	if (!pending_) {
+		return linked_;
+	}
+	EASY_FUNCTION();
+	pending_ = false;
+
+	GLint isLinked = 0;
+	glGetProgramiv(handle_, GL_LINK_STATUS, &isLinked);
+	linked_ = isLinked == GL_TRUE;
+
+	GLuint shaders[2] = {};
+	GLsizei numShaders = 0;
+	glGetAttachedShaders(handle_, 2, &numShaders, shaders);
+	if (!linked_)
+	{
+		for (GLsizei i = 0; i < numShaders; ++i) {
+			checkCompileStatus(shaders[i]);
+		}
+
+		GLint maxLength = 0;
+		glGetProgramiv(handle_, GL_INFO_LOG_LENGTH, &maxLength);
+
+		GLchar *errorLog = new GLchar[(int)maxLength];
+		glGetProgramInfoLog(handle_, maxLength, &maxLength, errorLog);
+
+		fprintf(stderr, "Error linking program: %s\n", errorLog);
+		delete[] errorLog;
+	}
+	else if (cache_) {
+		cache_->store(cacheKey_, handle_);
+	}
+	// The shaders aren't needed once the program is linked, detaching them deletes the ones whose GLShader is gone
+	for (GLsizei i = 0; i < numShaders; ++i) {
+		glDetachShader(handle_, shaders[i]);
+	}
+	return linked_;
+}
+
+GLProgram::~GLProgram() {
+	glDeleteProgram(handle_);
+}
+
+void GLProgram::swap(GLProgram &other) {
+	std::swap(handle_, other.handle_);
+	std::swap(pending_, other.pending_);
+	std::swap(linked_, other.linked_);
+	std::swap(cache_, other.cache_);
+	std::swap(cacheKey_, other.cacheKey_);
+	std::swap(vertexFileName_, other.vertexFileName_);
+	std::swap(fragmentFileName_, other.fragmentFileName_);
+}
+
+void GLProgram::useProgram() {
+	waitUntilLinked();
+	glUseProgram(handle_);
+}
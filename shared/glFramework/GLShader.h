@@ -0,0 +1,75 @@
+#pragma once
+
+#include <glad/gl.h>
+#include <stdint.h>
+#include <string>
+
+class GLProgramCache;
+
+// Lets the driver compile and link on its own threads when it supports GL_KHR_parallel_shader_compile.
+// GLApp calls it once the context is current, with the function that loaded GL
+void enableParallelShaderCompile(GLADloadfunc load);
+bool isParallelShaderCompileEnabled();
+
+class GLShader {
+public:
+	GLShader(GLenum type, const char *source);
+	// Loads the SPIR-V the ShaderCompiler tool built for fileName, or compiles its GLSL when the SPIR-V is
+	// missing or older than the source. The stage comes from the extension, see ShaderCompiler.h
+	explicit GLShader(const char *fileName);
+	~GLShader();
+
+	GLShader(const GLShader&) = delete;
+	GLShader& operator=(const GLShader&) = delete;
+
+	GLenum getType() const { return type_; }
+	GLuint getHandle() const { return handle_; }
+
+private:
+	void compile(const char *source);
+
+	GLenum type_;
+	GLuint handle_;
+};
+
+// Programs are linked in the background: creating one only submits its shaders to the driver, nothing waits
+// until the program is first used. Creating every program before using any lets the driver compile them in parallel
+class GLProgram {
+public:
+	GLProgram(const GLShader &a, const GLShader &b);
+	// Loads the program from the cache, the shader files are only loaded and linked when it misses
+	GLProgram(const GLProgramCache &cache, const char *vertexFileName, const char *fragmentFileName);
+	~GLProgram();
+
+	GLProgram(const GLProgram&) = delete;
+	GLProgram& operator=(const GLProgram&) = delete;
+
+	// The first time it waits for the program to be linked
+	void useProgram();
+	GLuint getHandle() const { return handle_; }
+
+	// Never waits. True once the driver is done with the program, whether linking it worked or not.
+	// Without parallel shader compilation there is no way to tell, so it's always true
+	bool isReady() const;
+	// Waits for the program to be linked and reports the errors of its shaders. Returns false when it failed
+	bool waitUntilLinked();
+
+	// Only programs built from shader files have them, GLProgramReloader rebuilds those when they change
+	const GLProgramCache *getCache() const { return cache_; }
+	const std::string &getVertexFileName() const { return vertexFileName_; }
+	const std::string &getFragmentFileName() const { return fragmentFileName_; }
+	// Exchanges the GL programs and everything known about them
+	void swap(GLProgram &other);
+
+private:
+	void link(const GLShader &a, const GLShader &b);
+
+	GLuint handle_;
+	bool pending_ = false;
+	bool linked_ = false;
+	// Where the program binary goes once it's linked
+	const GLProgramCache *cache_ = nullptr;
+	uint64_t cacheKey_ = 0;
+	std::string vertexFileName_;
+	std::string fragmentFileName_;
+};
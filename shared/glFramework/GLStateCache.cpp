@@ -0,0 +1,92 @@
+#include "shared/glFramework/GLStateCache.h"
+
+void GLStateCache::enable(GLenum capability) {
+	setCapability(capability, true);
+}
+
+void GLStateCache::disable(GLenum capability) {
+	setCapability(capability, false);
+}
+
+void GLStateCache::setCapability(GLenum capability, bool enabled) {
+	auto it = capabilities_.find(capability);
+	if (it == capabilities_.end()) {
+		it = capabilities_.emplace(capability, !enabled).first;
+	}
+	if (update(it->second, enabled)) {
+		if (enabled) {
+			glEnable(capability);
+		}
+		else {
+			glDisable(capability);
+		}
+	}
+}
+
+void GLStateCache::polygonMode(GLenum mode) {
+	if (update(polygonMode_, mode)) {
+		glPolygonMode(GL_FRONT_AND_BACK, mode);
+	}
+}
+
+void GLStateCache::polygonOffset(float factor, float units) {
+	if (hasPolygonOffset_ && polygonOffsetFactor_ == factor && polygonOffsetUnits_ == units) {
+		++stats_.filtered;
+		return;
+	}
+	hasPolygonOffset_ = true;
+	polygonOffsetFactor_ = factor;
+	polygonOffsetUnits_ = units;
+	++stats_.issued;
+	glPolygonOffset(factor, units);
+}
+
+void GLStateCache::bindVertexArray(GLuint vao) {
+	if (update(vertexArray_, vao)) {
+		glBindVertexArray(vao);
+		buffers_.erase(GL_ELEMENT_ARRAY_BUFFER);
+	}
+}
+
+void GLStateCache::bindBuffer(GLenum target, GLuint buffer) {
+	auto it = buffers_.find(target);
+	if (it == buffers_.end()) {
+		it = buffers_.emplace(target, kUnknown).first;
+	}
+	if (update(it->second, buffer)) {
+		glBindBuffer(target, buffer);
+	}
+}
+
+void GLStateCache::bindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size) {
+	const uint64_t key = ((uint64_t)target << 32) | index;
+	const BufferRange range = { .buffer = buffer, .offset = offset, .size = size };
+	auto it = bufferRanges_.find(key);
+	if (it != bufferRanges_.end() && it->second.buffer == buffer && it->second.offset == offset && it->second.size == size) {
+		++stats_.filtered;
+		return;
+	}
+	bufferRanges_[key] = range;
+	buffers_[target] = buffer;
+	++stats_.issued;
+	glBindBufferRange(target, index, buffer, offset, size);
+}
+
+void GLStateCache::bindTextureUnit(GLuint unit, GLuint texture) {
+	if (unit >= textureUnits_.size()) {
+		textureUnits_.resize(unit + 1, kUnknown);
+	}
+	if (update(textureUnits_[unit], texture)) {
+		glBindTextureUnit(unit, texture);
+	}
+}
+
+void GLStateCache::invalidate() {
+	capabilities_.clear();
+	polygonMode_ = 0;
+	hasPolygonOffset_ = false;
+	vertexArray_ = kUnknown;
+	buffers_.clear();
+	bufferRanges_.clear();
+	textureUnits_.clear();
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <glad/gl.h>
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+
+// Shadows the GL state an example changes every frame and drops the calls that wouldn't change anything.
+// Redundant calls aren't free, the driver validates every one of them and may flag state as dirty for the next draw.
+// The cache starts knowing nothing and learns the state from the calls that go through it, so the first call of each
+// kind is always issued. Code that changes the same state without the cache leaves it out of date, call invalidate()
+// after it. All of this is per context and only meant for the thread the context is current on.
+class GLStateCache {
+public:
+	struct Stats {
+		// Calls that reached the driver
+		uint64_t issued = 0;
+		// Calls dropped because the state already had that value
+		uint64_t filtered = 0;
+	};
+
+	GLStateCache() = default;
+
+	GLStateCache(const GLStateCache&) = delete;
+	GLStateCache& operator=(const GLStateCache&) = delete;
+
+	void enable(GLenum capability);
+	void disable(GLenum capability);
+	// Core profiles only accept GL_FRONT_AND_BACK
+	void polygonMode(GLenum mode);
+	void polygonOffset(float factor, float units);
+
+	// Programs aren't cached: the examples bind theirs once and GLProgramReloader rebinds it behind our back.
+	// Binding a VAO also changes the GL_ELEMENT_ARRAY_BUFFER binding, which we forget then
+	void bindVertexArray(GLuint vao);
+	void bindBuffer(GLenum target, GLuint buffer);
+	// Also binds buffer to the generic binding point of target, like glBindBufferRange
+	void bindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size);
+	void bindTextureUnit(GLuint unit, GLuint texture);
+
+	// Forgets everything, the next call of each kind is issued again
+	void invalidate();
+
+	// Counted since the cache was created, callers that want them per frame take the difference
+	const Stats &getStats() const { return stats_; }
+
+private:
+	struct BufferRange {
+		GLuint buffer;
+		GLintptr offset;
+		GLsizeiptr size;
+	};
+
+	// Returns true and counts the call as issued when value differs from cached, which then takes its value
+	template<typename T>
+	bool update(T &cached, const T &value) {
+		if (cached == value) {
+			++stats_.filtered;
+			return false;
+		}
+		cached = value;
+		++stats_.issued;
+		return true;
+	}
+
+	void setCapability(GLenum capability, bool enabled);
+
+	// Object names the cache hasn't seen bound yet. GL never generates this name
+	static const GLuint kUnknown = UINT32_MAX;
+
+	// Missing entries are unknown
+	std::unordered_map<GLenum, bool> capabilities_;
+	GLenum polygonMode_ = 0;
+	bool hasPolygonOffset_ = false;
+	float polygonOffsetFactor_ = 0.0f;
+	float polygonOffsetUnits_ = 0.0f;
+
+	GLuint vertexArray_ = kUnknown;
+	std::unordered_map<GLenum, GLuint> buffers_;
+	// Indexed by target in the upper 32 bits and binding index in the lower ones
+	std::unordered_map<uint64_t, BufferRange> bufferRanges_;
+	std::vector<GLuint> textureUnits_;
+
+	Stats stats_;
+};
@@ -0,0 +1,245 @@
+#include "shared/glFramework/GLTextureLoader.h"
+
+#include "shared/EasyProfilerWrapper.h"
+#include "shared/Hash.h"
+#include "stb_image.h"
+#include <gli/gli.hpp>
+#include <stdio.h>
+#include <string.h>
+#include <filesystem>
+#include <iterator>
+
+// Our textures are uploaded as GL_RGB8
+static const int kNumComponents = 3;
+
+GLTextureLoader::GLTextureLoader(const std::string &cacheDirectory, GLsizeiptr stagingSize)
+	: stagingBuffer_(stagingSize, 1, 3, GL_PIXEL_UNPACK_BUFFER)
+	, cache_(cacheDirectory) {
+	createPlaceholder();
+}
+
+GLTextureLoader::~GLTextureLoader() {
+	// The decoding tasks reference this object so they have to finish before anything is destroyed
+	executor_.wait_for_all();
+
+	for (const Texture &texture : textures_) {
+		if (texture.texture) {
+			glDeleteTextures(1, &texture.texture);
+		}
+	}
+	glDeleteTextures(1, &placeholder_);
+}
+
+GLTextureLoader::Handle GLTextureLoader::load(const char *path, GLenum minFilter, GLenum magFilter, MipFilter mipFilter) {
+	const Handle handle = (Handle)textures_.size();
+	textures_.push_back({ .path = path, .minFilter = minFilter, .magFilter = magFilter, .mipFilter = mipFilter });
+
+	const bool generateMipmaps = usesMipmaps(minFilter);
+	std::string imagePath = path;
+	executor_.silent_async([this, handle, imagePath, mipFilter, generateMipmaps]() {
+		decode(handle, imagePath, mipFilter, generateMipmaps);
+	});
+
+	return handle;
+}
+
+void GLTextureLoader::update() {
+	std::vector<DecodedImage> ready;
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		ready.swap(decoded_);
+	}
+	if (ready.empty()) {
+		return;
+	}
+
+	stagingBuffer_.beginFrame();
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+	size_t uploaded = 0;
+	for (; uploaded < ready.size(); ++uploaded) {
+		const DecodedImage &image = ready[uploaded];
+		const GLsizeiptr size = (GLsizeiptr)image.size;
+		// Images that don't fit in the staging buffer at all are uploaded directly from client memory.
+		// The rest wait for the next frame when the buffer is full so we don't stall this one
+		if (stagingBuffer_.getAlignedSize(size) > stagingBuffer_.getFreeSize() && size <= stagingBuffer_.getFrameSize()) {
+			break;
+		}
+		upload(image);
+	}
+	stagingBuffer_.endFrame();
+
+	if (uploaded < ready.size()) {
+		std::lock_guard<std::mutex> lock(mutex_);
+		decoded_.insert(decoded_.begin(), std::make_move_iterator(ready.begin() + uploaded), std::make_move_iterator(ready.end()));
+	}
+}
+
+GLuint GLTextureLoader::getTexture(Handle handle) const {
+	const GLuint texture = textures_[handle].texture;
+	return texture ? texture : placeholder_;
+}
+
+bool GLTextureLoader::isLoaded(Handle handle) const {
+	return textures_[handle].texture != 0;
+}
+
+void GLTextureLoader::createPlaceholder() {
+	// A 2x2 grey checkerboard that is easy to tell apart from real textures
+	const uint8_t pixels[] = {
+		64, 64, 64, 192, 192, 192,
+		192, 192, 192, 64, 64, 64
+	};
+	glCreateTextures(GL_TEXTURE_2D, 1, &placeholder_);
+	glTextureParameteri(placeholder_, GL_TEXTURE_MAX_LEVEL, 0);
+	glTextureParameteri(placeholder_, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTextureParameteri(placeholder_, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTextureStorage2D(placeholder_, 1, GL_RGB8, 2, 2);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glTextureSubImage2D(placeholder_, 0, 0, 0, 2, 2, GL_RGB, GL_UNSIGNED_BYTE, pixels);
+}
+
+bool GLTextureLoader::usesMipmaps(GLenum minFilter) {
+	return minFilter == GL_NEAREST_MIPMAP_NEAREST || minFilter == GL_LINEAR_MIPMAP_NEAREST ||
+		minFilter == GL_NEAREST_MIPMAP_LINEAR || minFilter == GL_LINEAR_MIPMAP_LINEAR;
+}
+
+std::string GLTextureLoader::getCompressedPath(const std::string &path) {
+	return std::filesystem::path(path).replace_extension(".ktx").string();
+}
+
+void GLTextureLoader::decode(Handle handle, const std::string &path, MipFilter mipFilter, bool generateMipmaps) {
+	EASY_THREAD("TextureLoader");
+	EASY_FUNCTION();
+	// The baked ETC2 version is preferred over the source image when it exists
+	const std::string compressedPath = getCompressedPath(path);
+	const bool isCompressed = std::filesystem::exists(compressedPath);
+	const std::string &sourcePath = isCompressed ? compressedPath : path;
+	MappedFile source(sourcePath);
+	if (!source.isValid()) {
+		fprintf(stderr, "Error loading %s\n", sourcePath.c_str());
+		return;
+	}
+
+	DecodedImage image = { .handle = handle };
+	uint64_t cacheKey = 0;
+	if (cache_.isEnabled()) {
+		// The key covers the source contents and everything that changes how we process them
+		cacheKey = hashBytes(source.getData(), source.getSize());
+		cacheKey = hashValue(isCompressed, cacheKey);
+		cacheKey = hashValue(generateMipmaps, cacheKey);
+		cacheKey = hashValue(mipFilter, cacheKey);
+		cacheKey = hashValue(kNumComponents, cacheKey);
+
+		TextureCache::Entry entry;
+		if (cache_.load(cacheKey, entry)) {
+			image.internalFormat = entry.internalFormat;
+			image.isCompressed = entry.isCompressed;
+			image.levels = std::move(entry.levels);
+			image.pixels = entry.pixels;
+			image.size = image.levels.back().offset + image.levels.back().size;
+			image.cacheFile = std::move(entry.file);
+
+			std::lock_guard<std::mutex> lock(mutex_);
+			decoded_.push_back(std::move(image));
+			return;
+		}
+	}
+
+	MipChain mipChain;
+	const bool loaded = isCompressed ?
+		loadCompressed(source, sourcePath, image.internalFormat, mipChain) :
+		decodeImage(source, sourcePath, mipFilter, generateMipmaps, image.internalFormat, mipChain);
+	if (!loaded) {
+		return;
+	}
+	cache_.store(cacheKey, image.internalFormat, isCompressed, mipChain);
+
+	image.isCompressed = isCompressed;
+	image.levels = mipChain.levels;
+	image.size = mipChain.data.size();
+	image.storage = std::move(mipChain.data);
+	image.pixels = image.storage.data();
+
+	std::lock_guard<std::mutex> lock(mutex_);
+	decoded_.push_back(std::move(image));
+}
+
+bool GLTextureLoader::decodeImage(const MappedFile &source, const std::string &path, MipFilter mipFilter, bool generateMipmaps,
+	GLenum &internalFormat, MipChain &mipChain) {
+	int w, h, comp;
+	uint8_t *pixels = stbi_load_from_memory(source.getData(), (int)source.getSize(), &w, &h, &comp, kNumComponents);
+	if (!pixels) {
+		fprintf(stderr, "Error loading %s: %s\n", path.c_str(), stbi_failure_reason());
+		return false;
+	}
+
+	internalFormat = GL_RGB8;
+	if (generateMipmaps) {
+		// Our images are stored in sRGB so we filter them in linear space
+		generateMipChain(pixels, w, h, kNumComponents, mipFilter, true, mipChain);
+	}
+	else {
+		const size_t size = (size_t)w * h * kNumComponents;
+		mipChain.numComponents = kNumComponents;
+		mipChain.levels.push_back({ .width = w, .height = h, .offset = 0, .size = size });
+		mipChain.data.assign(pixels, pixels + size);
+	}
+	stbi_image_free(pixels);
+	return true;
+}
+
+bool GLTextureLoader::loadCompressed(const MappedFile &source, const std::string &path, GLenum &internalFormat, MipChain &mipChain) {
+	gli::texture texture = gli::load_ktx((const char*)source.getData(), source.getSize());
+	if (texture.empty() || texture.target() != gli::TARGET_2D || texture.format() != gli::FORMAT_RGB_ETC2_UNORM_BLOCK8) {
+		fprintf(stderr, "Ignoring %s, it isn't a 2D ETC2 RGB texture\n", path.c_str());
+		return false;
+	}
+
+	// We copy the levels one after the other so the upload works the same as with uncompressed mip chains
+	internalFormat = GL_COMPRESSED_RGB8_ETC2;
+	mipChain.data.resize(texture.size());
+	size_t offset = 0;
+	for (size_t level = 0; level < texture.levels(); ++level) {
+		const size_t size = texture.size(level);
+		mipChain.levels.push_back({ .width = texture.extent(level).x, .height = texture.extent(level).y, .offset = offset, .size = size });
+		memcpy(mipChain.data.data() + offset, texture.data(0, 0, level), size);
+		offset += size;
+	}
+	return true;
+}
+
+void GLTextureLoader::upload(const DecodedImage &image) {
+	EASY_FUNCTION();
+	Texture &texture = textures_[image.handle];
+	const GLsizei numLevels = (GLsizei)image.levels.size();
+	glCreateTextures(GL_TEXTURE_2D, 1, &texture.texture);
+	glTextureParameteri(texture.texture, GL_TEXTURE_MAX_LEVEL, numLevels - 1);
+	glTextureParameteri(texture.texture, GL_TEXTURE_MIN_FILTER, texture.minFilter);
+	glTextureParameteri(texture.texture, GL_TEXTURE_MAG_FILTER, texture.magFilter);
+	glTextureStorage2D(texture.texture, numLevels, image.internalFormat, image.levels[0].width, image.levels[0].height);
+
+	// Every level is copied to the staging buffer at once, straight from the page cache when the image comes
+	// from the texture cache. With a buffer bound to GL_PIXEL_UNPACK_BUFFER the last parameter of
+	// glTextureSubImage2D is an offset into it and the copy happens on the GPU timeline
+	const GLsizeiptr size = (GLsizeiptr)image.size;
+	const bool useStagingBuffer = stagingBuffer_.getAlignedSize(size) <= stagingBuffer_.getFreeSize();
+	GLRingBuffer::Allocation allocation;
+	if (useStagingBuffer) {
+		allocation = stagingBuffer_.upload(image.pixels, size);
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, stagingBuffer_.getHandle());
+	}
+
+	for (GLsizei level = 0; level < numLevels; ++level) {
+		const MipChain::Level &mip = image.levels[level];
+		const void *data = useStagingBuffer ?
+			(const void*)(intptr_t)(allocation.offset + mip.offset) : image.pixels + mip.offset;
+		if (image.isCompressed) {
+			glCompressedTextureSubImage2D(texture.texture, level, 0, 0, mip.width, mip.height, image.internalFormat, (GLsizei)mip.size, data);
+		}
+		else {
+			glTextureSubImage2D(texture.texture, level, 0, 0, mip.width, mip.height, GL_RGB, GL_UNSIGNED_BYTE, data);
+		}
+	}
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
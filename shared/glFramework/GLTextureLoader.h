@@ -0,0 +1,82 @@
+#pragma once
+
+#include "shared/MappedFile.h"
+#include "shared/Mipmaps.h"
+#include "shared/TextureCache.h"
+#include "shared/glFramework/GLRingBuffer.h"
+#include "taskflow/taskflow.hpp"
+#include <glad/gl.h>
+#include <stdint.h>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Loads textures without blocking the render thread.
+// Images are decoded with STB on a Taskflow thread pool and uploaded on the GL thread through a
+// persistently mapped staging buffer. Until its upload finishes a texture is replaced by a placeholder.
+// When the minification filter uses mipmaps the whole chain is generated on the CPU while decoding.
+// If an ETC2 KTX file baked by the TextureBake tool exists next to the image it's loaded instead.
+// The processed result is stored in a TextureCache so the next launch skips decoding and filtering.
+class GLTextureLoader {
+public:
+	using Handle = uint32_t;
+
+	// stagingSize is the amount of bytes we can upload each frame. An empty cacheDirectory disables the cache
+	explicit GLTextureLoader(const std::string &cacheDirectory = ".cache/textures", GLsizeiptr stagingSize = 32 * 1024 * 1024);
+	~GLTextureLoader();
+
+	GLTextureLoader(const GLTextureLoader&) = delete;
+	GLTextureLoader& operator=(const GLTextureLoader&) = delete;
+
+	Handle load(const char *path, GLenum minFilter, GLenum magFilter, MipFilter mipFilter = MipFilter::Box);
+	// Uploads the images decoded so far. Call it once per frame from the GL thread
+	void update();
+
+	// Where TextureBake stores the compressed version of the image at path
+	static std::string getCompressedPath(const std::string &path);
+
+	// The GL texture to bind for handle, the placeholder while it's still loading
+	GLuint getTexture(Handle handle) const;
+	bool isLoaded(Handle handle) const;
+
+private:
+	struct Texture {
+		std::string path;
+		GLenum minFilter;
+		GLenum magFilter;
+		MipFilter mipFilter;
+		GLuint texture = 0;
+	};
+
+	struct DecodedImage {
+		Handle handle;
+		GLenum internalFormat = 0;
+		bool isCompressed = false;
+		std::vector<MipChain::Level> levels;
+		// Every level one after the other. They live either in storage or in the mapped cache entry
+		const uint8_t *pixels = nullptr;
+		size_t size = 0;
+		std::vector<uint8_t> storage;
+		std::unique_ptr<MappedFile> cacheFile;
+	};
+
+	void createPlaceholder();
+	static bool usesMipmaps(GLenum minFilter);
+	void decode(Handle handle, const std::string &path, MipFilter mipFilter, bool generateMipmaps);
+	static bool decodeImage(const MappedFile &source, const std::string &path, MipFilter mipFilter, bool generateMipmaps,
+		GLenum &internalFormat, MipChain &mipChain);
+	static bool loadCompressed(const MappedFile &source, const std::string &path, GLenum &internalFormat, MipChain &mipChain);
+	void upload(const DecodedImage &image);
+
+	std::vector<Texture> textures_;
+	GLuint placeholder_ = 0;
+	GLRingBuffer stagingBuffer_;
+	TextureCache cache_;
+
+	// Filled by the decoding tasks and emptied by update()
+	std::mutex mutex_;
+	std::vector<DecodedImage> decoded_;
+
+	tf::Executor executor_;
+};
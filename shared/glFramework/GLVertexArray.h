@@ -0,0 +1,25 @@
+#pragma once
+
+#include <glad/gl.h>
+
+// Our examples generate their vertices in the vertex shader but OpenGL still needs a VAO bound to draw
+class GLVertexArray {
+public:
+	GLVertexArray() {
+		glCreateVertexArrays(1, &handle_);
+	}
+	~GLVertexArray() {
+		glDeleteVertexArrays(1, &handle_);
+	}
+
+	GLVertexArray(const GLVertexArray&) = delete;
+	GLVertexArray& operator=(const GLVertexArray&) = delete;
+
+	void bind() const {
+		glBindVertexArray(handle_);
+	}
+	GLuint getHandle() const { return handle_; }
+
+private:
+	GLuint handle_ = 0;
+};
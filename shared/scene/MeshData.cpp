@@ -0,0 +1,165 @@
+#include "shared/scene/MeshData.h"
+
+#include "meshoptimizer/src/meshoptimizer.h"
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <filesystem>
+
+// Bump it whenever the file layout or the import changes
+static const uint32_t kMeshVersion = 3;
+static const uint32_t kMeshMagic = 0x4853454D; // "MESH"
+static const uint64_t kDataAlignment = 16;
+
+static uint64_t alignOffset(uint64_t offset) {
+	return (offset + kDataAlignment - 1) / kDataAlignment * kDataAlignment;
+}
+
+static void quantizeVertices(const std::vector<float> &vertices, uint8_t *out) {
+	const size_t numVertices = vertices.size() / kMeshVertexComponents;
+	for (size_t i = 0; i < numVertices; ++i) {
+		const float *v = vertices.data() + i * kMeshVertexComponents;
+		uint16_t *position = (uint16_t*)out;
+		int8_t *normal = (int8_t*)(out + 8);
+		uint16_t *uv = (uint16_t*)(out + 12);
+		for (int k = 0; k < 3; ++k) {
+			position[k] = meshopt_quantizeHalf(v[k]);
+			normal[k] = (int8_t)meshopt_quantizeSnorm(v[3 + k], 8);
+		}
+		position[3] = 0;
+		normal[3] = 0;
+		uv[0] = meshopt_quantizeHalf(v[6]);
+		uv[1] = meshopt_quantizeHalf(v[7]);
+		out += 16;
+	}
+}
+
+// True when count elements of elementSize bytes starting at offset fit in size bytes. Compared by subtracting
+// so the values of a corrupt file can't wrap around
+static bool fitsIn(uint64_t offset, uint64_t count, uint64_t elementSize, uint64_t size) {
+	return offset <= size && count <= (size - offset) / elementSize;
+}
+
+// Every submesh and every LOD must stay inside the vertex and index buffers, they are drawn and read without checks
+static bool isMeshValid(const Mesh &mesh, uint64_t numVertices, uint64_t numIndices) {
+	if (!fitsIn(mesh.vertexOffset, mesh.vertexCount, 1, numVertices) ||
+		!fitsIn(mesh.indexOffset, mesh.indexCount, 1, numIndices) ||
+		mesh.lodCount == 0 || mesh.lodCount > kMaxLODs || mesh.lodOffset[mesh.lodCount] > numIndices) {
+		return false;
+	}
+	for (uint32_t lod = 0; lod < mesh.lodCount; ++lod) {
+		if (mesh.lodOffset[lod] > mesh.lodOffset[lod + 1]) {
+			return false;
+		}
+	}
+	return true;
+}
+
+uint32_t getVertexFormatStride(VertexFormat format) {
+	return format == VertexFormat::Quantized ? 16 : kMeshVertexComponents * sizeof(float);
+}
+
+bool MeshData::load(const std::string &path, uint64_t sourceKey) {
+	auto file = std::make_unique<MappedFile>(path);
+	if (!file->isValid() || file->getSize() < sizeof(MeshFileHeader)) {
+		return false;
+	}
+
+	const MeshFileHeader *header = (const MeshFileHeader*)file->getData();
+	const uint64_t size = file->getSize();
+	if (header->magic != kMeshMagic || header->version != kMeshVersion ||
+		(sourceKey != 0 && header->sourceKey != sourceKey) ||
+		(header->indexSize != 2 && header->indexSize != 4) ||
+		(header->vertexFormat != VertexFormat::Float32 && header->vertexFormat != VertexFormat::Quantized) ||
+		header->vertexStride != getVertexFormatStride(header->vertexFormat) ||
+		header->meshesOffset % alignof(Mesh) != 0 || header->indexDataOffset % header->indexSize != 0 ||
+		!fitsIn(header->meshesOffset, header->numMeshes, sizeof(Mesh), size) ||
+		!fitsIn(header->vertexDataOffset, header->vertexDataSize, 1, size) ||
+		!fitsIn(header->indexDataOffset, header->indexDataSize, 1, size)) {
+		return false;
+	}
+
+	// The pointer fixup: every table is at a known offset from the start of the mapping
+	const uint8_t *data = file->getData();
+	const Mesh *meshes = (const Mesh*)(data + header->meshesOffset);
+	const uint64_t numVertices = header->vertexDataSize / header->vertexStride;
+	const uint64_t numIndices = header->indexDataSize / header->indexSize;
+	for (uint32_t i = 0; i < header->numMeshes; ++i) {
+		if (!isMeshValid(meshes[i], numVertices, numIndices)) {
+			return false;
+		}
+	}
+	header_ = header;
+	meshes_ = meshes;
+	vertexData_ = data + header->vertexDataOffset;
+	indexData_ = data + header->indexDataOffset;
+	file_ = std::move(file);
+	return true;
+}
+
+bool saveMeshData(const std::string &path, const MeshDataBuffers &buffers, uint64_t sourceKey) {
+	// Indices are relative to their mesh so we only need 32 bits when a single mesh is that large
+	uint32_t maxVertexCount = 0;
+	for (const Mesh &mesh : buffers.meshes) {
+		maxVertexCount = std::max(maxVertexCount, mesh.vertexCount);
+	}
+	const uint32_t indexSize = maxVertexCount <= 65536 ? 2 : 4;
+
+	MeshFileHeader header = {
+		.magic = kMeshMagic,
+		.version = kMeshVersion,
+		.sourceKey = sourceKey,
+		.numMeshes = (uint32_t)buffers.meshes.size(),
+		.vertexStride = getVertexFormatStride(buffers.vertexFormat),
+		.indexSize = indexSize,
+		.vertexFormat = buffers.vertexFormat
+	};
+	header.meshesOffset = alignOffset(sizeof(MeshFileHeader));
+	header.vertexDataOffset = alignOffset(header.meshesOffset + buffers.meshes.size() * sizeof(Mesh));
+	header.vertexDataSize = buffers.vertexData.size() / kMeshVertexComponents * header.vertexStride;
+	header.indexDataOffset = alignOffset(header.vertexDataOffset + header.vertexDataSize);
+	header.indexDataSize = buffers.indexData.size() * indexSize;
+
+	std::vector<uint8_t> file(header.indexDataOffset + header.indexDataSize);
+	memcpy(file.data(), &header, sizeof(header));
+	memcpy(file.data() + header.meshesOffset, buffers.meshes.data(), buffers.meshes.size() * sizeof(Mesh));
+	if (buffers.vertexFormat == VertexFormat::Quantized) {
+		quantizeVertices(buffers.vertexData, file.data() + header.vertexDataOffset);
+	}
+	else {
+		memcpy(file.data() + header.vertexDataOffset, buffers.vertexData.data(), header.vertexDataSize);
+	}
+	if (indexSize == 2) {
+		uint16_t *indices = (uint16_t*)(file.data() + header.indexDataOffset);
+		std::copy(buffers.indexData.begin(), buffers.indexData.end(), indices);
+	}
+	else {
+		memcpy(file.data() + header.indexDataOffset, buffers.indexData.data(), header.indexDataSize);
+	}
+
+	std::error_code error;
+	const std::filesystem::path parent = std::filesystem::path(path).parent_path();
+	if (!parent.empty()) {
+		std::filesystem::create_directories(parent, error);
+	}
+
+	// Written to a temporary file first so a crash never leaves a truncated mesh behind
+	const std::string temporaryPath = path + ".tmp";
+	FILE *f = fopen(temporaryPath.c_str(), "wb");
+	if (!f) {
+		fprintf(stderr, "Can't write mesh file %s\n", temporaryPath.c_str());
+		return false;
+	}
+	const bool written = fwrite(file.data(), 1, file.size(), f) == file.size();
+	fclose(f);
+
+	if (written) {
+		std::filesystem::rename(temporaryPath, path, error);
+	}
+	if (!written || error) {
+		fprintf(stderr, "Can't write mesh file %s\n", path.c_str());
+		std::filesystem::remove(temporaryPath, error);
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "shared/MappedFile.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Binary mesh format written once after an Assimp import so later launches skip the importer.
+// The file is a header, the mesh table and the vertex and index streams, each aligned to 16 bytes.
+// Loading maps the whole file and points into it, nothing is parsed or copied.
+
+// Components of an imported vertex: position (3), normal (3) and uv (2)
+static const uint32_t kMeshVertexComponents = 8;
+// Levels of detail stored for every mesh, including the full resolution one
+static const uint32_t kMaxLODs = 6;
+
+// How the interleaved vertices are stored in the file
+enum class VertexFormat : uint32_t {
+	// position, normal and uv as floats, 32 bytes
+	Float32,
+	// position as 3 half floats plus 2 bytes of padding, normal as 3 normalized signed bytes plus
+	// 1 byte of padding and uv as 2 half floats, 16 bytes
+	Quantized
+};
+
+uint32_t getVertexFormatStride(VertexFormat format);
+
+struct MeshFileHeader {
+	uint32_t magic;
+	uint32_t version;
+	// Identifies the version of the source file the mesh was imported from
+	uint64_t sourceKey;
+	uint32_t numMeshes;
+	uint32_t vertexStride;
+	// 2 or 4 bytes
+	uint32_t indexSize;
+	VertexFormat vertexFormat;
+	uint64_t meshesOffset;
+	uint64_t vertexDataOffset;
+	uint64_t vertexDataSize;
+	uint64_t indexDataOffset;
+	uint64_t indexDataSize;
+};
+
+// A submesh. Its indices are relative to vertexOffset so they fit in 16 bits whenever
+// every mesh has less than 65536 vertices, that's the base vertex of the draw call
+struct Mesh {
+	// In vertices
+	uint32_t vertexOffset;
+	uint32_t vertexCount;
+	// The full resolution mesh, in indices. The same range as LOD 0
+	uint32_t indexOffset;
+	uint32_t indexCount;
+	uint32_t materialIndex;
+	// LOD i uses the indices from lodOffset[i] to lodOffset[i + 1]. Every LOD uses the same vertices
+	uint32_t lodCount;
+	uint32_t lodOffset[kMaxLODs + 1];
+	// How far each LOD deviates from the full resolution mesh, in model units
+	float lodError[kMaxLODs];
+	// Center and radius in model space
+	float boundingSphere[4];
+
+	uint32_t getLODIndexCount(uint32_t lod) const { return lodOffset[lod + 1] - lodOffset[lod]; }
+};
+
+// What the importer produces and saveMeshData writes. Vertices are always floats and indices 32 bits here,
+// saveMeshData quantizes the vertices when asked to and narrows the indices when possible
+struct MeshDataBuffers {
+	std::vector<Mesh> meshes;
+	std::vector<float> vertexData;
+	std::vector<uint32_t> indexData;
+	VertexFormat vertexFormat = VertexFormat::Float32;
+};
+
+// A mesh file mapped in memory
+class MeshData {
+public:
+	// Fails when the file is missing, corrupt, from another version of the format or,
+	// if sourceKey isn't 0, imported from another version of the source file
+	bool load(const std::string &path, uint64_t sourceKey = 0);
+
+	uint32_t getNumMeshes() const { return header_->numMeshes; }
+	const Mesh &getMesh(uint32_t index) const { return meshes_[index]; }
+	const Mesh *getMeshes() const { return meshes_; }
+
+	VertexFormat getVertexFormat() const { return header_->vertexFormat; }
+	uint32_t getVertexStride() const { return header_->vertexStride; }
+	const uint8_t *getVertexData() const { return vertexData_; }
+	size_t getVertexDataSize() const { return (size_t)header_->vertexDataSize; }
+
+	uint32_t getIndexSize() const { return header_->indexSize; }
+	// Index i of the index buffer, whatever its size
+	uint32_t getIndex(size_t i) const {
+		return header_->indexSize == 2 ? ((const uint16_t*)indexData_)[i] : ((const uint32_t*)indexData_)[i];
+	}
+	const uint8_t *getIndexData() const { return indexData_; }
+	size_t getIndexDataSize() const { return (size_t)header_->indexDataSize; }
+
+private:
+	std::unique_ptr<MappedFile> file_;
+	const MeshFileHeader *header_ = nullptr;
+	const Mesh *meshes_ = nullptr;
+	const uint8_t *vertexData_ = nullptr;
+	const uint8_t *indexData_ = nullptr;
+};
+
+bool saveMeshData(const std::string &path, const MeshDataBuffers &buffers, uint64_t sourceKey);
@@ -0,0 +1,121 @@
+#include "shared/scene/MeshImport.h"
+
+#include "shared/EasyProfilerWrapper.h"
+#include "shared/Hash.h"
+#include <assimp/Importer.hpp>
+#include <assimp/postprocess.h>
+#include <assimp/scene.h>
+#include <stdio.h>
+#include <algorithm>
+#include <filesystem>
+
+static void convertMesh(const aiMesh *mesh, MeshDataBuffers &buffers) {
+	if (mesh->mNumVertices == 0) {
+		return;
+	}
+
+	const uint32_t vertexOffset = (uint32_t)(buffers.vertexData.size() / kMeshVertexComponents);
+	const uint32_t indexOffset = (uint32_t)buffers.indexData.size();
+
+	for (unsigned int i = 0; i < mesh->mNumVertices; ++i) {
+		const aiVector3D &p = mesh->mVertices[i];
+		const aiVector3D n = mesh->HasNormals() ? mesh->mNormals[i] : aiVector3D(0.0f, 0.0f, 1.0f);
+		const aiVector3D uv = mesh->HasTextureCoords(0) ? mesh->mTextureCoords[0][i] : aiVector3D();
+		buffers.vertexData.insert(buffers.vertexData.end(), { p.x, p.y, p.z, n.x, n.y, n.z, uv.x, uv.y });
+	}
+
+	// Triangulation already turned every face into a triangle, points and lines are dropped
+	for (unsigned int i = 0; i < mesh->mNumFaces; ++i) {
+		const aiFace &face = mesh->mFaces[i];
+		if (face.mNumIndices == 3) {
+			buffers.indexData.insert(buffers.indexData.end(), { face.mIndices[0], face.mIndices[1], face.mIndices[2] });
+		}
+	}
+
+	// The sphere around the center of the bounding box, a bit larger than the smallest one but good enough for LOD selection
+	aiVector3D minPosition = mesh->mVertices[0];
+	aiVector3D maxPosition = mesh->mVertices[0];
+	for (unsigned int i = 1; i < mesh->mNumVertices; ++i) {
+		const aiVector3D &p = mesh->mVertices[i];
+		minPosition = aiVector3D(std::min(minPosition.x, p.x), std::min(minPosition.y, p.y), std::min(minPosition.z, p.z));
+		maxPosition = aiVector3D(std::max(maxPosition.x, p.x), std::max(maxPosition.y, p.y), std::max(maxPosition.z, p.z));
+	}
+	const aiVector3D center = (minPosition + maxPosition) * 0.5f;
+	float radius = 0.0f;
+	for (unsigned int i = 0; i < mesh->mNumVertices; ++i) {
+		radius = std::max(radius, (mesh->mVertices[i] - center).Length());
+	}
+
+	// Only LOD 0 until the optimization stage generates the rest
+	const uint32_t indexCount = (uint32_t)buffers.indexData.size() - indexOffset;
+	buffers.meshes.push_back({
+		.vertexOffset = vertexOffset,
+		.vertexCount = mesh->mNumVertices,
+		.indexOffset = indexOffset,
+		.indexCount = indexCount,
+		.materialIndex = mesh->mMaterialIndex,
+		.lodCount = 1,
+		.lodOffset = { indexOffset, indexOffset + indexCount },
+		.lodError = { 0.0f },
+		.boundingSphere = { center.x, center.y, center.z, radius }
+	});
+}
+
+bool importMesh(const std::string &path, MeshDataBuffers &buffers) {
+	EASY_FUNCTION();
+	const unsigned int flags =
+		aiProcess_JoinIdenticalVertices |
+		aiProcess_Triangulate |
+		aiProcess_GenSmoothNormals |
+		aiProcess_SortByPType |
+		aiProcess_RemoveRedundantMaterials |
+		aiProcess_FindDegenerates |
+		aiProcess_FindInvalidData |
+		aiProcess_GenUVCoords;
+
+	Assimp::Importer importer;
+	const aiScene *scene = importer.ReadFile(path.c_str(), flags);
+	if (!scene || !scene->HasMeshes()) {
+		fprintf(stderr, "Error importing %s: %s\n", path.c_str(), importer.GetErrorString());
+		return false;
+	}
+
+	buffers = MeshDataBuffers();
+	for (unsigned int i = 0; i < scene->mNumMeshes; ++i) {
+		convertMesh(scene->mMeshes[i], buffers);
+	}
+	return true;
+}
+
+uint64_t getMeshSourceKey(const std::string &path) {
+	std::error_code error;
+	const uint64_t size = std::filesystem::file_size(path, error);
+	const int64_t time = std::filesystem::last_write_time(path, error).time_since_epoch().count();
+	return hashValue(time, hashValue(size));
+}
+
+std::string getMeshCachePath(const std::string &path, const std::string &cacheDirectory) {
+	// Named after the source path so scenes with the same file name in different folders don't collide
+	char name[24];
+	snprintf(name, sizeof(name), "%016llx.mesh", (unsigned long long)hashBytes(path.data(), path.size()));
+	return (std::filesystem::path(cacheDirectory) / name).string();
+}
+
+bool loadMeshCached(const std::string &path, MeshData &meshData, const MeshOptimizeSettings &settings, const std::string &cacheDirectory) {
+	EASY_FUNCTION();
+	const uint64_t sourceKey = hashMeshOptimizeSettings(settings, getMeshSourceKey(path));
+	const std::string cachePath = getMeshCachePath(path, cacheDirectory);
+	if (meshData.load(cachePath, sourceKey)) {
+		return true;
+	}
+
+	MeshDataBuffers buffers;
+	if (!importMesh(path, buffers)) {
+		return false;
+	}
+	optimizeMeshData(buffers, settings);
+	if (!saveMeshData(cachePath, buffers, sourceKey)) {
+		return false;
+	}
+	return meshData.load(cachePath, sourceKey);
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "shared/scene/MeshData.h"
+#include "shared/scene/MeshOptimize.h"
+#include <stdint.h>
+#include <string>
+
+// Imports every mesh of a scene file (OBJ or glTF) with Assimp into the layout of our mesh files
+bool importMesh(const std::string &path, MeshDataBuffers &buffers);
+
+// Changes whenever the file at path is modified, without reading it
+uint64_t getMeshSourceKey(const std::string &path);
+
+// Where loadMeshCached keeps the binary version of the scene at path
+std::string getMeshCachePath(const std::string &path, const std::string &cacheDirectory);
+
+// Maps the binary version of the scene at path, importing, optimizing and saving it first
+// when it's missing, out of date or was optimized with other settings
+bool loadMeshCached(const std::string &path, MeshData &meshData, const MeshOptimizeSettings &settings = MeshOptimizeSettings(),
+	const std::string &cacheDirectory = ".cache/meshes");
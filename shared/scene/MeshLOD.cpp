@@ -0,0 +1,29 @@
+#include "shared/scene/MeshLOD.h"
+
+#include <algorithm>
+
+uint32_t selectLOD(const Mesh &mesh, const glm::mat4 &modelView, const glm::mat4 &proj, float viewportHeight, float maxErrorPixels) {
+	if (mesh.lodCount <= 1) {
+		return 0;
+	}
+
+	// Model matrices may scale the mesh, we use the largest axis so we never pick a LOD too coarse
+	const float scale = std::max({
+		glm::length(glm::vec3(modelView[0])), glm::length(glm::vec3(modelView[1])), glm::length(glm::vec3(modelView[2]))
+	});
+	const glm::vec3 center = glm::vec3(modelView * glm::vec4(mesh.boundingSphere[0], mesh.boundingSphere[1], mesh.boundingSphere[2], 1.0f));
+	const float distance = glm::length(center) - mesh.boundingSphere[3] * scale;
+	if (distance <= 0.0f) {
+		return 0;
+	}
+
+	// proj[1][1] is the cotangent of half the vertical field of view, the same factor the projection
+	// applies to y before the perspective division
+	const float pixelsPerUnit = proj[1][1] * 0.5f * viewportHeight / distance;
+	for (uint32_t lod = mesh.lodCount - 1; lod > 0; --lod) {
+		if (mesh.lodError[lod] * scale * pixelsPerUnit <= maxErrorPixels) {
+			return lod;
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+#include "shared/scene/MeshData.h"
+#include <glm/glm.hpp>
+#include <stdint.h>
+
+// Picks the coarsest LOD of mesh whose error covers at most maxErrorPixels on screen.
+// modelView and proj are the matrices the mesh is drawn with, the error is projected at the point of
+// the bounding sphere closest to the camera so the choice doesn't depend on the orientation of the object
+uint32_t selectLOD(const Mesh &mesh, const glm::mat4 &modelView, const glm::mat4 &proj, float viewportHeight, float maxErrorPixels = 1.0f);
@@ -0,0 +1,161 @@
+#include "shared/scene/MeshOptimize.h"
+
+#include "shared/EasyProfilerWrapper.h"
+#include "shared/Hash.h"
+#include "meshoptimizer/src/meshoptimizer.h"
+#include <stdio.h>
+#include <algorithm>
+
+// The FIFO size meshoptimizer simulates, close to the post-transform cache of current GPUs
+static const unsigned int kCacheSize = 16;
+static const size_t kVertexStride = kMeshVertexComponents * sizeof(float);
+
+static void analyzeMesh(const uint32_t *indices, size_t indexCount, const float *vertices, size_t vertexCount,
+	float &acmr, float &atvr, float &overdraw) {
+	const meshopt_VertexCacheStatistics cache = meshopt_analyzeVertexCache(indices, indexCount, vertexCount, kCacheSize, 0, 0);
+	const meshopt_OverdrawStatistics overdrawStats = meshopt_analyzeOverdraw(indices, indexCount, vertices, vertexCount, kVertexStride);
+	acmr = cache.acmr;
+	atvr = cache.atvr;
+	overdraw = overdrawStats.overdraw;
+}
+
+// Appends the LODs of mesh to indexData, their indices are optimized for the vertex cache as well
+static void generateLODs(Mesh &mesh, const float *vertices, const MeshOptimizeSettings &settings, std::vector<uint32_t> &indexData) {
+	const uint32_t *indices = indexData.data() + mesh.indexOffset;
+	const std::vector<uint32_t> lod0(indices, indices + mesh.indexCount);
+	// meshopt_simplify reports errors relative to the mesh extents
+	const float errorScale = meshopt_simplifyScale(vertices, mesh.vertexCount, kVertexStride);
+
+	std::vector<uint32_t> lod(lod0.size());
+	size_t previousCount = lod0.size();
+	const uint32_t numLODs = std::min(settings.numLODs, kMaxLODs);
+	while (mesh.lodCount < numLODs) {
+		const size_t targetCount = (size_t)(previousCount / 3 * settings.lodReduction) * 3;
+		if (targetCount < settings.lodMinTriangles * 3) {
+			break;
+		}
+
+		// Every LOD is simplified from the full mesh so errors don't add up. meshopt_simplify keeps the topology
+		// and gets stuck on meshes with many seams, then we fall back to the sloppy version that doesn't
+		float error = 0.0f;
+		size_t count = meshopt_simplify(lod.data(), lod0.data(), lod0.size(), vertices, mesh.vertexCount, kVertexStride,
+			targetCount, settings.lodMaxError, &error);
+		if (count > (previousCount + targetCount) / 2) {
+			count = meshopt_simplifySloppy(lod.data(), lod0.data(), lod0.size(), vertices, mesh.vertexCount, kVertexStride,
+				targetCount, settings.lodMaxError, &error);
+		}
+		if (count == 0 || count > (previousCount + targetCount) / 2) {
+			break;
+		}
+
+		meshopt_optimizeVertexCache(lod.data(), lod.data(), count, mesh.vertexCount);
+		mesh.lodOffset[mesh.lodCount] = (uint32_t)indexData.size();
+		mesh.lodError[mesh.lodCount] = error * errorScale;
+		indexData.insert(indexData.end(), lod.begin(), lod.begin() + count);
+		mesh.lodOffset[++mesh.lodCount] = (uint32_t)indexData.size();
+		previousCount = count;
+	}
+}
+
+void optimizeMeshData(MeshDataBuffers &buffers, const MeshOptimizeSettings &settings, std::vector<MeshOptimizeStats> *stats) {
+	EASY_FUNCTION();
+	if (stats) {
+		stats->clear();
+	}
+
+	// Meshes own contiguous ranges of both buffers and their indices are relative to their first vertex,
+	// so each one is optimized in place
+	for (const Mesh &mesh : buffers.meshes) {
+		uint32_t *indices = buffers.indexData.data() + mesh.indexOffset;
+		float *vertices = buffers.vertexData.data() + (size_t)mesh.vertexOffset * kMeshVertexComponents;
+		const size_t indexCount = mesh.indexCount;
+		const size_t vertexCount = mesh.vertexCount;
+		if (indexCount == 0) {
+			continue;
+		}
+
+		MeshOptimizeStats meshStats = { .vertexCount = mesh.vertexCount, .triangleCount = mesh.indexCount / 3 };
+		if (stats) {
+			analyzeMesh(indices, indexCount, vertices, vertexCount, meshStats.acmrBefore, meshStats.atvrBefore, meshStats.overdrawBefore);
+		}
+
+		if (settings.optimizeVertexCache) {
+			meshopt_optimizeVertexCache(indices, indices, indexCount, vertexCount);
+		}
+		if (settings.optimizeOverdraw) {
+			// Positions are the first 3 floats of every vertex
+			meshopt_optimizeOverdraw(indices, indices, indexCount, vertices, vertexCount, kVertexStride, settings.overdrawThreshold);
+		}
+		if (settings.optimizeVertexFetch) {
+			// Vertices no triangle uses end up past the ones that are, we leave them there so the ranges don't change
+			meshopt_optimizeVertexFetch(vertices, indices, indexCount, vertices, vertexCount, kVertexStride);
+		}
+
+		if (stats) {
+			analyzeMesh(indices, indexCount, vertices, vertexCount, meshStats.acmrAfter, meshStats.atvrAfter, meshStats.overdrawAfter);
+			stats->push_back(meshStats);
+		}
+	}
+
+	// The LODs of every mesh have to follow its LOD 0 so we rebuild the index buffer
+	if (settings.numLODs > 1) {
+		std::vector<uint32_t> indexData;
+		indexData.reserve(buffers.indexData.size() * 2);
+		for (Mesh &mesh : buffers.meshes) {
+			const uint32_t *indices = buffers.indexData.data() + mesh.indexOffset;
+			mesh.indexOffset = (uint32_t)indexData.size();
+			mesh.lodCount = 1;
+			mesh.lodOffset[0] = mesh.indexOffset;
+			mesh.lodOffset[1] = mesh.indexOffset + mesh.indexCount;
+			mesh.lodError[0] = 0.0f;
+			indexData.insert(indexData.end(), indices, indices + mesh.indexCount);
+			if (mesh.indexCount > 0) {
+				generateLODs(mesh, buffers.vertexData.data() + (size_t)mesh.vertexOffset * kMeshVertexComponents, settings, indexData);
+			}
+		}
+		buffers.indexData.swap(indexData);
+	}
+
+	buffers.vertexFormat = settings.quantize ? VertexFormat::Quantized : VertexFormat::Float32;
+}
+
+void printMeshOptimizeReport(const std::vector<MeshOptimizeStats> &stats) {
+	printf("%6s %10s %10s %15s %15s %15s\n", "Mesh", "Vertices", "Triangles", "ACMR", "ATVR", "Overdraw");
+
+	double triangles = 0.0;
+	double vertices = 0.0;
+	double total[6] = {};
+	for (size_t i = 0; i < stats.size(); ++i) {
+		const MeshOptimizeStats &s = stats[i];
+		printf("%6zu %10u %10u %6.3f -> %5.3f %6.3f -> %5.3f %6.3f -> %5.3f\n", i, s.vertexCount, s.triangleCount,
+			s.acmrBefore, s.acmrAfter, s.atvrBefore, s.atvrAfter, s.overdrawBefore, s.overdrawAfter);
+
+		// ACMR and overdraw are averaged per triangle, ATVR per vertex
+		triangles += s.triangleCount;
+		vertices += s.vertexCount;
+		total[0] += s.acmrBefore * s.triangleCount;
+		total[1] += s.acmrAfter * s.triangleCount;
+		total[2] += s.atvrBefore * s.vertexCount;
+		total[3] += s.atvrAfter * s.vertexCount;
+		total[4] += s.overdrawBefore * s.triangleCount;
+		total[5] += s.overdrawAfter * s.triangleCount;
+	}
+
+	if (triangles > 0.0) {
+		printf("%6s %10.0f %10.0f %6.3f -> %5.3f %6.3f -> %5.3f %6.3f -> %5.3f\n", "Total", vertices, triangles,
+			total[0] / triangles, total[1] / triangles, total[2] / vertices, total[3] / vertices,
+			total[4] / triangles, total[5] / triangles);
+	}
+}
+
+uint64_t hashMeshOptimizeSettings(const MeshOptimizeSettings &settings, uint64_t seed) {
+	uint64_t hash = hashValue(settings.optimizeVertexCache, seed);
+	hash = hashValue(settings.optimizeOverdraw, hash);
+	hash = hashValue(settings.overdrawThreshold, hash);
+	hash = hashValue(settings.optimizeVertexFetch, hash);
+	hash = hashValue(settings.quantize, hash);
+	hash = hashValue(settings.numLODs, hash);
+	hash = hashValue(settings.lodReduction, hash);
+	hash = hashValue(settings.lodMinTriangles, hash);
+	return hashValue(settings.lodMaxError, hash);
+}
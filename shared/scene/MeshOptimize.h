@@ -0,0 +1,50 @@
+#pragma once
+
+#include "shared/scene/MeshData.h"
+#include <stdint.h>
+#include <vector>
+
+// The meshoptimizer stage of the import pipeline, run on every mesh before it's saved
+struct MeshOptimizeSettings {
+	// Reorders triangles to reuse more vertices from the post-transform cache
+	bool optimizeVertexCache = true;
+	// Reorders clusters of triangles to draw the ones in front first, it can undo some of the cache gains
+	bool optimizeOverdraw = true;
+	// How much worse than the vertex cache order the overdraw optimizer may make ACMR
+	float overdrawThreshold = 1.05f;
+	// Reorders vertices in the order triangles use them so fetching them touches memory linearly
+	bool optimizeVertexFetch = true;
+	// Stores vertices with VertexFormat::Quantized
+	bool quantize = false;
+
+	// LODs generated with meshopt_simplify for every mesh, including the full resolution one. 1 disables them
+	uint32_t numLODs = kMaxLODs;
+	// Each LOD aims for this fraction of the triangles of the previous one
+	float lodReduction = 0.5f;
+	// We stop before reaching numLODs once a mesh has less triangles than this
+	uint32_t lodMinTriangles = 64;
+	// Largest deviation a LOD may have from the full resolution mesh, relative to the mesh extents
+	float lodMaxError = 0.1f;
+};
+
+// Post-transform cache and overdraw statistics of LOD 0 of a mesh before and after the optimizations.
+// ACMR is the number of vertices transformed per triangle, around 0.5 at best for a regular grid, and ATVR the number
+// per vertex, 1 at best
+struct MeshOptimizeStats {
+	uint32_t vertexCount;
+	uint32_t triangleCount;
+	float acmrBefore;
+	float atvrBefore;
+	float overdrawBefore;
+	float acmrAfter;
+	float atvrAfter;
+	float overdrawAfter;
+};
+
+// Analyzing overdraw rasterizes every mesh so stats are only computed when they are requested
+void optimizeMeshData(MeshDataBuffers &buffers, const MeshOptimizeSettings &settings, std::vector<MeshOptimizeStats> *stats = nullptr);
+
+// Prints one line per mesh and the totals weighted by triangle count
+void printMeshOptimizeReport(const std::vector<MeshOptimizeStats> &stats);
+
+uint64_t hashMeshOptimizeSettings(const MeshOptimizeSettings &settings, uint64_t seed);
@@ -0,0 +1,157 @@
+#include "shared/scene/Meshlets.h"
+
+#include "meshoptimizer/src/meshoptimizer.h"
+#include <math.h>
+#include <string.h>
+
+namespace {
+
+float halfToFloat(uint16_t h) {
+	const uint32_t sign = (uint32_t)(h & 0x8000) << 16;
+	const uint32_t exponent = (h >> 10) & 0x1F;
+	const uint32_t mantissa = h & 0x3FF;
+	uint32_t bits;
+	if (exponent == 0) {
+		// Zero or denormal, we normalize it
+		const float value = ldexpf((float)mantissa, -24);
+		memcpy(&bits, &value, sizeof(bits));
+		bits |= sign;
+	}
+	else if (exponent == 31) {
+		bits = sign | 0x7F800000 | (mantissa << 13);
+	}
+	else {
+		bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+	}
+	float result;
+	memcpy(&result, &bits, sizeof(result));
+	return result;
+}
+
+}
+
+void getFrustumPlanes(const glm::mat4 &viewProj, glm::vec4 planes[6]) {
+	// Gribb and Hartmann, every plane is a combination of the rows of the matrix
+	const glm::mat4 m = glm::transpose(viewProj);
+	planes[0] = m[3] + m[0];
+	planes[1] = m[3] - m[0];
+	planes[2] = m[3] + m[1];
+	planes[3] = m[3] - m[1];
+	planes[4] = m[3] + m[2];
+	planes[5] = m[3] - m[2];
+	for (int i = 0; i < 6; ++i) {
+		planes[i] = planes[i] / glm::length(glm::vec3(planes[i]));
+	}
+}
+
+void getVertexPositions(const MeshData &meshData, std::vector<float> &positions) {
+	const size_t numVertices = meshData.getVertexDataSize() / meshData.getVertexStride();
+	positions.resize(numVertices * 3);
+	const uint8_t *vertex = meshData.getVertexData();
+	for (size_t i = 0; i < numVertices; ++i, vertex += meshData.getVertexStride()) {
+		if (meshData.getVertexFormat() == VertexFormat::Quantized) {
+			const uint16_t *position = (const uint16_t*)vertex;
+			for (int k = 0; k < 3; ++k) {
+				positions[i * 3 + k] = halfToFloat(position[k]);
+			}
+		}
+		else {
+			memcpy(&positions[i * 3], vertex, 3 * sizeof(float));
+		}
+	}
+}
+
+void buildMeshlets(const MeshData &meshData, MeshletData &meshletData, uint32_t maxVertices, uint32_t maxTriangles, float coneWeight) {
+	meshletData = MeshletData();
+
+	std::vector<float> positions;
+	getVertexPositions(meshData, positions);
+
+	std::vector<uint32_t> indices;
+	std::vector<meshopt_Meshlet> meshlets;
+	std::vector<uint32_t> meshletVertices;
+	std::vector<uint8_t> meshletTriangles;
+	for (uint32_t m = 0; m < meshData.getNumMeshes(); ++m) {
+		const Mesh &mesh = meshData.getMesh(m);
+		if (mesh.indexCount == 0) {
+			continue;
+		}
+
+		indices.resize(mesh.indexCount);
+		for (uint32_t i = 0; i < mesh.indexCount; ++i) {
+			indices[i] = meshData.getIndex(mesh.indexOffset + i);
+		}
+		const float *meshPositions = positions.data() + (size_t)mesh.vertexOffset * 3;
+
+		const size_t maxMeshlets = meshopt_buildMeshletsBound(indices.size(), maxVertices, maxTriangles);
+		meshlets.resize(maxMeshlets);
+		meshletVertices.resize(maxMeshlets * maxVertices);
+		meshletTriangles.resize(maxMeshlets * maxTriangles * 3);
+		const size_t count = meshopt_buildMeshlets(meshlets.data(), meshletVertices.data(), meshletTriangles.data(),
+			indices.data(), indices.size(), meshPositions, mesh.vertexCount, 3 * sizeof(float), maxVertices, maxTriangles, coneWeight);
+
+		for (size_t i = 0; i < count; ++i) {
+			const meshopt_Meshlet &meshlet = meshlets[i];
+			const meshopt_Bounds bounds = meshopt_computeMeshletBounds(&meshletVertices[meshlet.vertex_offset],
+				&meshletTriangles[meshlet.triangle_offset], meshlet.triangle_count, meshPositions, mesh.vertexCount, 3 * sizeof(float));
+
+			// We pack the triangles tightly, meshoptimizer pads every meshlet to 4 bytes
+			meshletData.meshlets.push_back({
+				.vertexOffset = (uint32_t)meshletData.vertices.size(),
+				.triangleOffset = (uint32_t)meshletData.triangles.size() / 3,
+				.vertexCount = meshlet.vertex_count,
+				.triangleCount = meshlet.triangle_count,
+				.baseVertex = mesh.vertexOffset,
+				.center = { bounds.center[0], bounds.center[1], bounds.center[2] },
+				.radius = bounds.radius,
+				.coneAxis = { bounds.cone_axis[0], bounds.cone_axis[1], bounds.cone_axis[2] },
+				.coneCutoff = bounds.cone_cutoff
+			});
+			meshletData.vertices.insert(meshletData.vertices.end(),
+				meshletVertices.begin() + meshlet.vertex_offset, meshletVertices.begin() + meshlet.vertex_offset + meshlet.vertex_count);
+			meshletData.triangles.insert(meshletData.triangles.end(),
+				meshletTriangles.begin() + meshlet.triangle_offset, meshletTriangles.begin() + meshlet.triangle_offset + meshlet.triangle_count * 3);
+		}
+	}
+}
+
+void cullMeshlets(const MeshletData &meshletData, const glm::mat4 &viewProj, const glm::vec3 &cameraPosition,
+	std::vector<uint32_t> &indices, MeshletCullingStats *stats) {
+	glm::vec4 planes[6];
+	getFrustumPlanes(viewProj, planes);
+
+	MeshletCullingStats result;
+	result.meshlets = (uint32_t)meshletData.meshlets.size();
+	indices.clear();
+	for (const Meshlet &meshlet : meshletData.meshlets) {
+		const glm::vec3 center(meshlet.center[0], meshlet.center[1], meshlet.center[2]);
+
+		// The cone test from meshoptimizer that accounts for the size of the meshlet, so it doesn't need the apex
+		const glm::vec3 toCenter = center - cameraPosition;
+		const glm::vec3 coneAxis(meshlet.coneAxis[0], meshlet.coneAxis[1], meshlet.coneAxis[2]);
+		if (glm::dot(toCenter, coneAxis) >= meshlet.coneCutoff * glm::length(toCenter) + meshlet.radius) {
+			++result.culledByCone;
+			continue;
+		}
+
+		bool outside = false;
+		for (int i = 0; i < 6 && !outside; ++i) {
+			outside = glm::dot(glm::vec3(planes[i]), center) + planes[i].w < -meshlet.radius;
+		}
+		if (outside) {
+			++result.culledByFrustum;
+			continue;
+		}
+
+		const uint32_t *vertices = &meshletData.vertices[meshlet.vertexOffset];
+		const uint8_t *triangles = &meshletData.triangles[(size_t)meshlet.triangleOffset * 3];
+		for (uint32_t i = 0; i < meshlet.triangleCount * 3; ++i) {
+			indices.push_back(meshlet.baseVertex + vertices[triangles[i]]);
+		}
+		result.visibleTriangles += meshlet.triangleCount;
+	}
+
+	if (stats) {
+		*stats = result;
+	}
+}
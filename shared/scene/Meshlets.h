@@ -0,0 +1,53 @@
+#pragma once
+
+#include "shared/scene/MeshData.h"
+#include <glm/glm.hpp>
+#include <stdint.h>
+#include <vector>
+
+// Small clusters of triangles built with meshopt_buildMeshlets, each with a bounding sphere and a normal cone
+// so whole clusters can be culled on the CPU before drawing
+struct Meshlet {
+	// Into MeshletData::vertices and MeshletData::triangles
+	uint32_t vertexOffset;
+	uint32_t triangleOffset;
+	uint32_t vertexCount;
+	uint32_t triangleCount;
+	// Added to every vertex of the meshlet, the vertexOffset of the mesh it belongs to
+	uint32_t baseVertex;
+	float center[3];
+	float radius;
+	// Every triangle faces away from a camera for which dot(center - camera, coneAxis) >= coneCutoff * distance(center, camera) + radius
+	float coneAxis[3];
+	float coneCutoff;
+};
+
+struct MeshletData {
+	std::vector<Meshlet> meshlets;
+	// Vertices of each meshlet, relative to its baseVertex
+	std::vector<uint32_t> vertices;
+	// 3 bytes per triangle indexing the vertices of its meshlet
+	std::vector<uint8_t> triangles;
+};
+
+struct MeshletCullingStats {
+	uint32_t meshlets = 0;
+	uint32_t culledByCone = 0;
+	uint32_t culledByFrustum = 0;
+	uint32_t visibleTriangles = 0;
+};
+
+// Splits LOD 0 of every mesh into meshlets. The defaults are the sizes recommended for NVIDIA mesh shaders
+void buildMeshlets(const MeshData &meshData, MeshletData &meshletData, uint32_t maxVertices = 64, uint32_t maxTriangles = 124, float coneWeight = 0.25f);
+
+// Writes the triangles of the meshlets that survive backface cone and frustum sphere culling as one list of
+// 32 bit indices into the vertex buffer of the scene, ready for a single glDrawElements.
+// The scene is in world space, viewProj is its view-projection matrix and cameraPosition in world space too
+void cullMeshlets(const MeshletData &meshletData, const glm::mat4 &viewProj, const glm::vec3 &cameraPosition,
+	std::vector<uint32_t> &indices, MeshletCullingStats *stats = nullptr);
+
+// The 6 planes of the frustum as (normal, distance) with normalized normals pointing inside
+void getFrustumPlanes(const glm::mat4 &viewProj, glm::vec4 planes[6]);
+
+// World space positions of every vertex of meshData, whatever its vertex format
+void getVertexPositions(const MeshData &meshData, std::vector<float> &positions);
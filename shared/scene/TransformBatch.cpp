@@ -0,0 +1,236 @@
+#include "shared/scene/TransformBatch.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define TRANSFORMS_AVX2 1
+static const size_t kLanes = 8;
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define TRANSFORMS_SSE2 1
+static const size_t kLanes = 4;
+#endif
+
+using glm::mat4;
+using glm::quat;
+using glm::vec3;
+using glm::vec4;
+
+void TransformBatch::resize(size_t count) {
+	positionX.resize(count, 0.0f);
+	positionY.resize(count, 0.0f);
+	positionZ.resize(count, 0.0f);
+	rotationX.resize(count, 0.0f);
+	rotationY.resize(count, 0.0f);
+	rotationZ.resize(count, 0.0f);
+	rotationW.resize(count, 1.0f);
+	scaleX.resize(count, 1.0f);
+	scaleY.resize(count, 1.0f);
+	scaleZ.resize(count, 1.0f);
+}
+
+void TransformBatch::set(size_t index, const vec3 &position, const quat &rotation, const vec3 &scale) {
+	setPosition(index, position);
+	setRotation(index, rotation);
+	scaleX[index] = scale.x;
+	scaleY[index] = scale.y;
+	scaleZ[index] = scale.z;
+}
+
+void TransformBatch::setPosition(size_t index, const vec3 &position) {
+	positionX[index] = position.x;
+	positionY[index] = position.y;
+	positionZ[index] = position.z;
+}
+
+void TransformBatch::setRotation(size_t index, const quat &rotation) {
+	rotationX[index] = rotation.x;
+	rotationY[index] = rotation.y;
+	rotationZ[index] = rotation.z;
+	rotationW[index] = rotation.w;
+}
+
+const char *getTransformsCodePath() {
+#if TRANSFORMS_AVX2
+	return "AVX2";
+#elif TRANSFORMS_SSE2
+	return "SSE2";
+#else
+	return "scalar";
+#endif
+}
+
+// One transform at a time, for the ones left over after the last full group of lanes and for builds without SIMD.
+// It's the same math as the SIMD path, not glm's, so every transform of a batch is computed the same way
+static void computeTransform(const TransformBatch &batch, size_t i, const mat4 &parent, mat4 &matrix, mat4 *model) {
+	const float x = batch.rotationX[i];
+	const float y = batch.rotationY[i];
+	const float z = batch.rotationZ[i];
+	const float w = batch.rotationW[i];
+	const float sx = batch.scaleX[i];
+	const float sy = batch.scaleY[i];
+	const float sz = batch.scaleZ[i];
+	const mat4 m(
+		vec4(sx * (1.0f - 2.0f * (y * y + z * z)), sx * 2.0f * (x * y + w * z), sx * 2.0f * (x * z - w * y), 0.0f),
+		vec4(sy * 2.0f * (x * y - w * z), sy * (1.0f - 2.0f * (x * x + z * z)), sy * 2.0f * (y * z + w * x), 0.0f),
+		vec4(sz * 2.0f * (x * z + w * y), sz * 2.0f * (y * z - w * x), sz * (1.0f - 2.0f * (x * x + y * y)), 0.0f),
+		vec4(batch.positionX[i], batch.positionY[i], batch.positionZ[i], 1.0f));
+	matrix = parent * m;
+	if (model) {
+		*model = m;
+	}
+}
+
+// Lanes holds one element of the matrices of kLanes transforms, the kernel below is written once against these
+#if TRANSFORMS_AVX2
+
+using Lanes = __m256;
+static inline Lanes load(const float *p) { return _mm256_loadu_ps(p); }
+static inline Lanes broadcast(float v) { return _mm256_set1_ps(v); }
+static inline Lanes add(Lanes a, Lanes b) { return _mm256_add_ps(a, b); }
+static inline Lanes sub(Lanes a, Lanes b) { return _mm256_sub_ps(a, b); }
+static inline Lanes mul(Lanes a, Lanes b) { return _mm256_mul_ps(a, b); }
+// a * b + c
+static inline Lanes madd(Lanes a, Lanes b, Lanes c) {
+#if defined(__FMA__)
+	return _mm256_fmadd_ps(a, b, c);
+#else
+	return _mm256_add_ps(_mm256_mul_ps(a, b), c);
+#endif
+}
+
+// Transposes 8 registers so register i holds element i of each of them
+static inline void transpose8(Lanes *r) {
+	const __m256 t0 = _mm256_unpacklo_ps(r[0], r[1]);
+	const __m256 t1 = _mm256_unpackhi_ps(r[0], r[1]);
+	const __m256 t2 = _mm256_unpacklo_ps(r[2], r[3]);
+	const __m256 t3 = _mm256_unpackhi_ps(r[2], r[3]);
+	const __m256 t4 = _mm256_unpacklo_ps(r[4], r[5]);
+	const __m256 t5 = _mm256_unpackhi_ps(r[4], r[5]);
+	const __m256 t6 = _mm256_unpacklo_ps(r[6], r[7]);
+	const __m256 t7 = _mm256_unpackhi_ps(r[6], r[7]);
+	const __m256 s0 = _mm256_shuffle_ps(t0, t2, 0x44);
+	const __m256 s1 = _mm256_shuffle_ps(t0, t2, 0xEE);
+	const __m256 s2 = _mm256_shuffle_ps(t1, t3, 0x44);
+	const __m256 s3 = _mm256_shuffle_ps(t1, t3, 0xEE);
+	const __m256 s4 = _mm256_shuffle_ps(t4, t6, 0x44);
+	const __m256 s5 = _mm256_shuffle_ps(t4, t6, 0xEE);
+	const __m256 s6 = _mm256_shuffle_ps(t5, t7, 0x44);
+	const __m256 s7 = _mm256_shuffle_ps(t5, t7, 0xEE);
+	r[0] = _mm256_permute2f128_ps(s0, s4, 0x20);
+	r[1] = _mm256_permute2f128_ps(s1, s5, 0x20);
+	r[2] = _mm256_permute2f128_ps(s2, s6, 0x20);
+	r[3] = _mm256_permute2f128_ps(s3, s7, 0x20);
+	r[4] = _mm256_permute2f128_ps(s0, s4, 0x31);
+	r[5] = _mm256_permute2f128_ps(s1, s5, 0x31);
+	r[6] = _mm256_permute2f128_ps(s2, s6, 0x31);
+	r[7] = _mm256_permute2f128_ps(s3, s7, 0x31);
+}
+
+// m[k] holds element k of 8 column-major matrices, written one after another to out
+static inline void storeMatrices(const Lanes *m, float *out) {
+	Lanes low[8] = { m[0], m[1], m[2], m[3], m[4], m[5], m[6], m[7] };
+	Lanes high[8] = { m[8], m[9], m[10], m[11], m[12], m[13], m[14], m[15] };
+	transpose8(low);
+	transpose8(high);
+	for (size_t i = 0; i < 8; ++i) {
+		_mm256_storeu_ps(out + i * 16, low[i]);
+		_mm256_storeu_ps(out + i * 16 + 8, high[i]);
+	}
+}
+
+#elif TRANSFORMS_SSE2
+
+using Lanes = __m128;
+static inline Lanes load(const float *p) { return _mm_loadu_ps(p); }
+static inline Lanes broadcast(float v) { return _mm_set1_ps(v); }
+static inline Lanes add(Lanes a, Lanes b) { return _mm_add_ps(a, b); }
+static inline Lanes sub(Lanes a, Lanes b) { return _mm_sub_ps(a, b); }
+static inline Lanes mul(Lanes a, Lanes b) { return _mm_mul_ps(a, b); }
+// a * b + c
+static inline Lanes madd(Lanes a, Lanes b, Lanes c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+
+// m[k] holds element k of 4 column-major matrices, written one after another to out
+static inline void storeMatrices(const Lanes *m, float *out) {
+	for (size_t column = 0; column < 4; ++column) {
+		Lanes r0 = m[column * 4];
+		Lanes r1 = m[column * 4 + 1];
+		Lanes r2 = m[column * 4 + 2];
+		Lanes r3 = m[column * 4 + 3];
+		_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+		_mm_storeu_ps(out + column * 4, r0);
+		_mm_storeu_ps(out + 16 + column * 4, r1);
+		_mm_storeu_ps(out + 32 + column * 4, r2);
+		_mm_storeu_ps(out + 48 + column * 4, r3);
+	}
+}
+
+#endif
+
+#if TRANSFORMS_AVX2 || TRANSFORMS_SSE2
+
+// Computes the transforms first to first + kLanes. parent holds every element of the parent matrix in all the lanes
+static void computeLanes(const TransformBatch &batch, size_t first, const Lanes *parent, float *matrices, float *models) {
+	const Lanes x = load(&batch.rotationX[first]);
+	const Lanes y = load(&batch.rotationY[first]);
+	const Lanes z = load(&batch.rotationZ[first]);
+	const Lanes w = load(&batch.rotationW[first]);
+	const Lanes sx = load(&batch.scaleX[first]);
+	const Lanes sy = load(&batch.scaleY[first]);
+	const Lanes sz = load(&batch.scaleZ[first]);
+	const Lanes zero = broadcast(0.0f);
+	const Lanes one = broadcast(1.0f);
+	const Lanes two = broadcast(2.0f);
+
+	// The model matrix, the rotation of the quaternion with its columns scaled and the translation
+	const Lanes x2 = mul(x, two);
+	const Lanes y2 = mul(y, two);
+	const Lanes z2 = mul(z, two);
+	const Lanes xx = mul(x, x2);
+	const Lanes yy = mul(y, y2);
+	const Lanes zz = mul(z, z2);
+	const Lanes xy = mul(x, y2);
+	const Lanes xz = mul(x, z2);
+	const Lanes yz = mul(y, z2);
+	const Lanes wx = mul(w, x2);
+	const Lanes wy = mul(w, y2);
+	const Lanes wz = mul(w, z2);
+	const Lanes m[16] = {
+		mul(sx, sub(one, add(yy, zz))), mul(sx, add(xy, wz)), mul(sx, sub(xz, wy)), zero,
+		mul(sy, sub(xy, wz)), mul(sy, sub(one, add(xx, zz))), mul(sy, add(yz, wx)), zero,
+		mul(sz, add(xz, wy)), mul(sz, sub(yz, wx)), mul(sz, sub(one, add(xx, yy))), zero,
+		load(&batch.positionX[first]), load(&batch.positionY[first]), load(&batch.positionZ[first]), one
+	};
+	if (models) {
+		storeMatrices(m, models);
+	}
+
+	// parent * m. The last row of m is (0, 0, 0, 1), so its first 3 columns don't need the 4th column of parent
+	Lanes result[16];
+	for (size_t column = 0; column < 4; ++column) {
+		const Lanes *c = &m[column * 4];
+		for (size_t row = 0; row < 4; ++row) {
+			const Lanes sum = madd(parent[8 + row], c[2], madd(parent[4 + row], c[1], mul(parent[row], c[0])));
+			result[column * 4 + row] = column == 3 ? add(sum, parent[12 + row]) : sum;
+		}
+	}
+	storeMatrices(result, matrices);
+}
+
+#endif
+
+void computeTransforms(const TransformBatch &batch, const mat4 &parent, mat4 *matrices, mat4 *models) {
+	const size_t count = batch.size();
+	size_t i = 0;
+#if TRANSFORMS_AVX2 || TRANSFORMS_SSE2
+	Lanes parentLanes[16];
+	for (size_t k = 0; k < 16; ++k) {
+		parentLanes[k] = broadcast(parent[(int)(k / 4)][(int)(k % 4)]);
+	}
+	for (; i + kLanes <= count; i += kLanes) {
+		computeLanes(batch, i, parentLanes, &matrices[i][0][0], models ? &models[i][0][0] : nullptr);
+	}
+#endif
+	for (; i < count; ++i) {
+		computeTransform(batch, i, parent, matrices[i], models ? &models[i] : nullptr);
+	}
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <stddef.h>
+#include <vector>
+
+// The translation, rotation and scale of many objects with one array per component, so computeTransforms loads
+// the same component of 8 objects with a single AVX2 load, 4 with SSE2, instead of gathering them from each object
+struct TransformBatch {
+	std::vector<float> positionX;
+	std::vector<float> positionY;
+	std::vector<float> positionZ;
+	// Unit quaternions
+	std::vector<float> rotationX;
+	std::vector<float> rotationY;
+	std::vector<float> rotationZ;
+	std::vector<float> rotationW;
+	std::vector<float> scaleX;
+	std::vector<float> scaleY;
+	std::vector<float> scaleZ;
+
+	size_t size() const { return positionX.size(); }
+	// Transforms added at the end are the identity
+	void resize(size_t count);
+	void set(size_t index, const glm::vec3 &position, const glm::quat &rotation, const glm::vec3 &scale);
+	void setPosition(size_t index, const glm::vec3 &position);
+	void setRotation(size_t index, const glm::quat &rotation);
+};
+
+// Writes parent * translate(position) * mat4_cast(rotation) * scale(scale) for every transform of the batch into matrices.
+// With the view-projection matrix as parent these are the MVP matrices, with the identity the model matrices.
+// models, when not null, also receives the model matrices computed on the way. Both arrays hold batch.size() matrices
+void computeTransforms(const TransformBatch &batch, const glm::mat4 &parent, glm::mat4 *matrices, glm::mat4 *models = nullptr);
+
+// "AVX2", "SSE2" or "scalar", the code path computeTransforms was built with
+const char *getTransformsCodePath();